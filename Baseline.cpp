@@ -0,0 +1,355 @@
+#include "Baseline.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+// First line of every baseline file. Bump the number if the layout changes.
+static const char* baselineHeader = "wasmDecomp-ir 3";
+
+// Lines of context printed around each change.
+static const int contextLines = 3;
+
+// Past this many cells the line matching gives up and replaces the whole middle.
+static const size_t diffCellLimit = 4 * 1024 * 1024;
+
+///	<summary>Reads a baseline written by save. The layout is a header line, a line holding
+///	"module hash", then for each function a line holding "func index key lineCount name"
+///	followed by its printed lines.</summary>
+Baseline Baseline::load(const std::string& filename)
+{
+	std::ifstream in(filename);
+	if (!in)
+		throw std::exception("Unable to open the baseline file");
+
+	// The header is followed by the name of the emitter and the decode options
+	std::string line;
+	const std::string header = baselineHeader;
+	if (!std::getline(in, line) || line.compare(0, header.size() + 1, header + ' ') != 0)
+		throw std::exception("Not a baseline file, or one written by another version");
+
+	Baseline result;
+	const size_t split = line.find(' ', header.size() + 1);
+	if (split == std::string::npos)
+		throw std::exception("The baseline file has no decode options");
+	result.format = line.substr(header.size() + 1, split - header.size() - 1);
+	result.decoding = line.substr(split + 1);
+
+	std::string moduleTag;
+	if (!(in >> moduleTag >> std::hex >> result.moduleHash >> std::dec) || moduleTag != "module")
+		throw std::exception("The baseline file has no module hash");
+
+	while (std::getline(in, line))
+	{
+		if (line.empty())
+			continue;
+
+		std::istringstream header(line);
+		std::string tag;
+		baselineFunction func;
+		size_t lineCount = 0;
+		header >> tag >> func.index >> std::hex >> func.key >> std::dec >> lineCount;
+		if (!header || tag != "func")
+			throw std::exception("Malformed function entry in the baseline file");
+
+		// The name is the rest of the line, and may be empty.
+		header.get();
+		std::getline(header, func.name);
+
+		func.lines.resize(lineCount);
+		for (auto& printed : func.lines)
+		{
+			if (!std::getline(in, printed))
+				throw std::exception("Baseline file ends in the middle of a function");
+		}
+		result.functions.push_back(std::move(func));
+	}
+
+	return result;
+}
+
+void Baseline::save(const std::string& filename) const
+{
+	std::ofstream out(filename);
+	if (!out)
+		throw std::exception("Unable to write the baseline file");
+
+	out << baselineHeader << ' ' << format << ' ' << decoding << '\n';
+	out << "module " << std::hex << moduleHash << std::dec << '\n';
+	for (const auto& func : functions)
+	{
+		out << "func " << func.index << ' ' << std::hex << func.key << std::dec << ' '
+			<< func.lines.size() << ' ' << func.name << '\n';
+		for (const auto& printed : func.lines)
+			out << printed << '\n';
+	}
+}
+
+void Baseline::add(int index, uint64_t key, std::string_view name, const std::string& printed)
+{
+	baselineFunction func;
+	func.index = index;
+	func.key = key;
+	func.name = std::string(name);
+	func.lines = splitLines(printed);
+	functions.push_back(std::move(func));
+}
+
+///	<summary>The body hash mixed with the signature's types. The signature is printed
+///	along with the body, so a change to it has to count as a change to the function.</summary>
+uint64_t Baseline::functionKey(const Function& func)
+{
+	const std::vector<byte>& types = func.getSignature().encoding;
+	return hashBytes(types.data(), types.size(), func.getBodyHash());
+}
+
+///	<summary>The decode options that change what gets printed, as saved in a baseline.</summary>
+std::string Baseline::optionsName(const decodeOptions& options)
+{
+	return options.simplify ? "simplify" : "no-simplify";
+}
+
+///	<summary>Decodes and renders every defined function into a fresh baseline.</summary>
+Baseline Baseline::fromModule(Mediator& current, const Emitter& emitter)
+{
+	Baseline result;
+	result.format = emitter.name();
+	result.decoding = optionsName(current.getOptions());
+	result.moduleHash = current.getModuleHash();
+	for (int i = 0; i < current.getFunctionCount(); ++i)
+	{
+		Function& func = current.getFunction(i);
+		if (func.isImported)
+			continue;
+
+		current.decodeFunction(i);
+		std::string printed;
+		emitter.emit(func, i, printed);
+		current.releaseFunction(i);
+		result.add(i, functionKey(func), func.getTitle(), printed);
+	}
+	return result;
+}
+
+///	<summary>Compares a module against this baseline. Only functions that are new or whose
+///	name or key changed get decoded; the rest reuse their old lines, unless anything else
+///	in the module that gets printed changed too. Changed functions are
+///	printed as a diff, and next receives the baseline for the module as it is now.
+///	Returns the number of functions that were new, changed or removed.</summary>
+int Baseline::compare(Mediator& current, const Emitter& emitter, std::ostream& out, Baseline& next) const
+{
+	if (format != emitter.name())
+		throw std::exception("The baseline was rendered with a different emitter");
+	if (decoding != optionsName(current.getOptions()))
+		throw std::exception("The baseline was rendered with different decode options");
+
+	std::unordered_map<std::string, size_t> byName;
+	std::unordered_multimap<uint64_t, size_t> byKey;
+	for (size_t i = 0; i < functions.size(); ++i)
+	{
+		if (!functions[i].name.empty())
+			byName.emplace(functions[i].name, i);
+		byKey.emplace(functions[i].key, i);
+	}
+
+	// Names are matched first for the whole module, so a body that moved to a new
+	// name can't take the entry of a function that kept its own.
+	std::vector<bool> used(functions.size(), false);
+	std::vector<const baselineFunction*> matches(current.getFunctionCount(), nullptr);
+	for (int i = 0; i < current.getFunctionCount(); ++i)
+	{
+		const Function& func = current.getFunction(i);
+		auto named = func.getTitle().empty() ? byName.end() : byName.find(std::string(func.getTitle()));
+		if (func.isImported || named == byName.end() || used[named->second])
+			continue;
+
+		matches[i] = &functions[named->second];
+		used[named->second] = true;
+	}
+
+	for (int i = 0; i < current.getFunctionCount(); ++i)
+	{
+		const Function& func = current.getFunction(i);
+		if (func.isImported || matches[i])
+			continue;
+
+		auto range = byKey.equal_range(functionKey(func));
+		for (auto it = range.first; it != range.second; ++it)
+		{
+			if (used[it->second])
+				continue;
+
+			matches[i] = &functions[it->second];
+			used[it->second] = true;
+			break;
+		}
+	}
+
+	int unchanged = 0, changed = 0, added = 0;
+	next.functions.clear();
+	next.format = format;
+	next.decoding = decoding;
+	next.moduleHash = current.getModuleHash();
+	const bool sameModule = next.moduleHash == moduleHash;
+
+	for (int i = 0; i < current.getFunctionCount(); ++i)
+	{
+		Function& func = current.getFunction(i);
+		if (func.isImported)
+			continue;
+
+		const uint64_t key = functionKey(func);
+		const std::string name(func.getTitle());
+		const baselineFunction* previous = matches[i];
+
+		if (sameModule && previous && previous->key == key && previous->name == name)
+		{
+			// Nothing that gets printed changed, so the old text is still right.
+			baselineFunction same = *previous;
+			same.index = i;
+			next.functions.push_back(std::move(same));
+			unchanged++;
+			continue;
+		}
+
+		current.decodeFunction(i);
+		std::string printed;
+		emitter.emit(func, i, printed);
+		current.releaseFunction(i);
+		next.add(i, key, name, printed);
+
+		const auto& lines = next.functions.back().lines;
+		if (previous)
+		{
+			out << "changed: " << (name.empty() ? previous->name : name) << std::endl;
+			out << "--- baseline" << std::endl << "+++ current" << std::endl;
+			printDiff(previous->lines, lines, out);
+			changed++;
+		}
+		else
+		{
+			out << "new: " << name << " (function " << i << ")" << std::endl;
+			for (const auto& line : lines)
+				out << '+' << line << std::endl;
+			added++;
+		}
+		out << std::endl;
+	}
+
+	int removed = 0;
+	for (size_t i = 0; i < functions.size(); ++i)
+	{
+		if (used[i])
+			continue;
+
+		out << "removed: " << functions[i].name << " (was function " << functions[i].index << ")" << std::endl << std::endl;
+		removed++;
+	}
+
+	out << unchanged << " unchanged, " << changed << " changed, " << added << " new, "
+		<< removed << " removed" << std::endl;
+	return changed + added + removed;
+}
+
+std::vector<std::string> Baseline::splitLines(const std::string& text)
+{
+	std::vector<std::string> lines;
+	std::istringstream in(text);
+	std::string line;
+	while (std::getline(in, line))
+		lines.push_back(line);
+	return lines;
+}
+
+///	<summary>Prints a unified style diff of two sets of lines. The common start and end
+///	are trimmed first, as edits between builds are usually small, and the remaining
+///	middle is matched with a longest common subsequence.</summary>
+void Baseline::printDiff(const std::vector<std::string>& before, const std::vector<std::string>& after, std::ostream& out)
+{
+	size_t prefix = 0;
+	while (prefix < before.size() && prefix < after.size() && before[prefix] == after[prefix])
+		prefix++;
+
+	size_t suffix = 0;
+	while (suffix < before.size() - prefix && suffix < after.size() - prefix
+		&& before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix])
+		suffix++;
+
+	const size_t n = before.size() - prefix - suffix;
+	const size_t m = after.size() - prefix - suffix;
+
+	// Each edit is a marker (' ', '-' or '+') and the line it refers to.
+	std::vector<std::pair<char, const std::string*>> edits;
+	for (size_t i = 0; i < prefix; ++i)
+		edits.emplace_back(' ', &before[i]);
+
+	if ((n + 1) * (m + 1) <= diffCellLimit)
+	{
+		// lcs[i][j] is the common length of the middles from i and j onwards.
+		std::vector<uint32_t> lcs((n + 1) * (m + 1), 0);
+		auto at = [&](size_t i, size_t j) -> uint32_t& { return lcs[i * (m + 1) + j]; };
+		for (size_t i = n; i-- > 0;)
+		{
+			for (size_t j = m; j-- > 0;)
+			{
+				if (before[prefix + i] == after[prefix + j])
+					at(i, j) = at(i + 1, j + 1) + 1;
+				else
+					at(i, j) = std::max(at(i + 1, j), at(i, j + 1));
+			}
+		}
+
+		size_t i = 0, j = 0;
+		while (i < n || j < m)
+		{
+			if (i < n && j < m && before[prefix + i] == after[prefix + j])
+			{
+				edits.emplace_back(' ', &before[prefix + i]);
+				i++;
+				j++;
+			}
+			else if (j == m || (i < n && at(i + 1, j) >= at(i, j + 1)))
+				edits.emplace_back('-', &before[prefix + i++]);
+			else
+				edits.emplace_back('+', &after[prefix + j++]);
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < n; ++i)
+			edits.emplace_back('-', &before[prefix + i]);
+		for (size_t j = 0; j < m; ++j)
+			edits.emplace_back('+', &after[prefix + j]);
+	}
+
+	for (size_t i = before.size() - suffix; i < before.size(); ++i)
+		edits.emplace_back(' ', &before[i]);
+
+	// Only print the lines near a change, with a marker between separate hunks.
+	std::vector<bool> shown(edits.size(), false);
+	for (size_t k = 0; k < edits.size(); ++k)
+	{
+		if (edits[k].first == ' ')
+			continue;
+
+		const size_t from = k < (size_t)contextLines ? 0 : k - contextLines;
+		const size_t to = std::min(edits.size(), k + contextLines + 1);
+		for (size_t c = from; c < to; ++c)
+			shown[c] = true;
+	}
+
+	bool inHunk = false;
+	for (size_t k = 0; k < edits.size(); ++k)
+	{
+		if (!shown[k])
+		{
+			inHunk = false;
+			continue;
+		}
+
+		if (!inHunk)
+			out << "@@" << std::endl;
+		inHunk = true;
+		out << edits[k].first << *edits[k].second << std::endl;
+	}
+}
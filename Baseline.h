@@ -0,0 +1,57 @@
+#ifndef BASELINE_H
+#define BASELINE_H
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Mediator.h"
+
+///	<summary>One function as it was printed by an earlier run.</summary>
+struct baselineFunction
+{
+	int index = 0;
+	uint64_t key = 0;
+	std::string name{};
+	std::vector<std::string> lines{};
+};
+
+///	<summary>
+///	The printed functions of an earlier run, kept so that the next build of
+///	the same module only has to decode what changed.<br>
+///	A function is considered unchanged when its name and key match an entry
+///	of the baseline and the rest of the module is the same. The key is the hash
+///	of the body mixed with the types of the signature. The printed text also
+///	depends on the module around the body (data strings, call_indirect targets,
+///	the names of callees and imports), so the baseline keeps a hash of those
+///	sections too. When that hash differs every function is decoded again, and
+///	still diffed against its old lines.<br>
+///	Functions are matched by name first, and by key when they have no name
+///	or their name is new, so renamed functions still diff against their old body.<br>
+///	The lines are only comparable when they come from the same emitter and the
+///	same decode options, so the emitter's name and the options that change the
+///	printed text are saved along with them.
+///	</summary>
+class Baseline
+{
+public:
+	static Baseline load(const std::string& filename);
+	void save(const std::string& filename) const;
+
+	void add(int index, uint64_t key, std::string_view name, const std::string& printed);
+	int compare(Mediator& current, const Emitter& emitter, std::ostream& out, Baseline& next) const;
+
+	static uint64_t functionKey(const Function& func);
+	static Baseline fromModule(Mediator& current, const Emitter& emitter);
+	static std::string optionsName(const decodeOptions& options);
+
+private:
+	static std::vector<std::string> splitLines(const std::string& text);
+	static void printDiff(const std::vector<std::string>& before, const std::vector<std::string>& after, std::ostream& out);
+
+	std::string format; // Name of the emitter the lines were rendered with
+	std::string decoding; // optionsName of the decode options the lines were rendered with
+	uint64_t moduleHash = 0; // Mediator::getModuleHash of the module the lines came from
+	std::vector<baselineFunction> functions;
+};
+
+#endif // BASELINE_H
@@ -0,0 +1,151 @@
+#include "BodyIndex.h"
+#include "maths.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+// First line of every saved index. Bump the number if the layout changes.
+static const char* indexHeader = "wasmDecomp-index 1";
+
+///	<summary>Scans the contents of a code section that starts at 'sectionOffset' in the file.
+///	A body that runs past the end of the section stops the scan, since nothing after it
+///	can be found; the bodies before it are kept and isComplete() tells the difference.</summary>
+BodyIndex BodyIndex::build(const std::vector<byte>& section, uint32_t sectionOffset)
+{
+	BodyIndex result;
+	result.sectionOffset = sectionOffset;
+	result.sectionLength = (uint32_t)section.size();
+	if (section.empty())
+		return result;
+
+	int count;
+	int pos = getNextu32(section, 0, count);
+	result.declared = (uint32_t)count;
+
+	// Every body takes at least two bytes, which bounds how much room is worth reserving
+	result.bodies.reserve(std::min<size_t>((uint32_t)count, section.size() / 2));
+	for (uint32_t i = 0; i < (uint32_t)count && pos < (int)section.size(); ++i)
+	{
+		bodyEntry entry;
+		entry.offset = sectionOffset + pos;
+
+		int size;
+		pos += getNextu32(section, pos, size);
+		if (size < 0 || size > (int)section.size() - pos)
+			break;
+
+		// The locals declaration is a vector of (count, type) pairs
+		const int end = pos + size;
+		int at = pos;
+		int runs = 0;
+		if (at < end)
+			at += getNextu32(section, at, runs);
+		for (int k = 0; k < runs && at < end; ++k)
+		{
+			int ignored;
+			at += getNextu32(section, at, ignored) + 1;
+		}
+
+		entry.size = size;
+		entry.locals = sectionOffset + pos;
+		entry.code = sectionOffset + std::min(at, end);
+		result.bodies.push_back(entry);
+		pos = end;
+	}
+
+	return result;
+}
+
+///	<summary>Reads an index written by save: a header line with where the code section
+///	was, then one line per body with its offset, size, locals and code.</summary>
+BodyIndex BodyIndex::load(const std::string& filename)
+{
+	std::ifstream in(filename);
+	if (!in)
+		throw std::exception("Unable to open the body index file");
+
+	std::string line;
+	const std::string header = indexHeader;
+	if (!std::getline(in, line) || line.compare(0, header.size() + 1, header + ' ') != 0)
+		throw std::exception("Not a body index file, or one written by another version");
+
+	BodyIndex result;
+	size_t count = 0;
+	std::istringstream fields(line.substr(header.size() + 1));
+	fields >> result.sectionOffset >> result.sectionLength >> result.declared >> count;
+	if (!fields)
+		throw std::exception("Malformed body index header");
+
+	result.bodies.resize(count);
+	for (auto& entry : result.bodies)
+	{
+		if (!(in >> entry.offset >> entry.size >> entry.locals >> entry.code))
+			throw std::exception("Body index file ends early");
+	}
+
+	return result;
+}
+
+void BodyIndex::save(const std::string& filename) const
+{
+	std::ofstream out(filename);
+	if (!out)
+		throw std::exception("Unable to write the body index file");
+
+	out << indexHeader << ' ' << sectionOffset << ' ' << sectionLength << ' ' << declared << ' ' << bodies.size() << '\n';
+	for (const auto& entry : bodies)
+		out << entry.offset << ' ' << entry.size << ' ' << entry.locals << ' ' << entry.code << '\n';
+}
+
+///	<summary>Number of bodies found.</summary>
+size_t BodyIndex::size() const
+{
+	return bodies.size();
+}
+
+const bodyEntry& BodyIndex::at(size_t index) const
+{
+	return bodies.at(index);
+}
+
+///	<summary>The position of the body holding a file offset, size prefix included, or -1
+///	if the offset isn't inside any body.</summary>
+int BodyIndex::find(uint32_t fileOffset) const
+{
+	auto it = std::upper_bound(bodies.begin(), bodies.end(), fileOffset,
+		[](uint32_t value, const bodyEntry& entry) { return value < entry.offset; });
+	if (it == bodies.begin())
+		return -1;
+
+	--it;
+	if ((uint64_t)fileOffset >= (uint64_t)it->locals + it->size)
+		return -1;
+
+	return (int)(it - bodies.begin());
+}
+
+///	<summary>Whether the index was made for a code section at this place in the file, and
+///	its entries make sense for it: in order, and each body inside the section.</summary>
+bool BodyIndex::matches(uint32_t offset, uint32_t length) const
+{
+	if (sectionOffset != offset || sectionLength != length || bodies.size() > declared)
+		return false;
+
+	const uint64_t end = (uint64_t)offset + length;
+	uint64_t previous = offset;
+	for (const auto& entry : bodies)
+	{
+		if (entry.offset < previous || entry.locals < entry.offset || entry.code < entry.locals
+			|| (uint64_t)entry.locals + entry.size > end || entry.code > (uint64_t)entry.locals + entry.size)
+			return false;
+
+		previous = (uint64_t)entry.locals + entry.size;
+	}
+	return true;
+}
+
+///	<summary>Whether every body the section declares was found.</summary>
+bool BodyIndex::isComplete() const
+{
+	return bodies.size() == declared;
+}
@@ -0,0 +1,49 @@
+#ifndef BODYINDEX_H
+#define BODYINDEX_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef unsigned char byte;
+
+///	<summary>Where one function body is in the file. All four are file offsets, apart
+///	from 'size', which counts the bytes after the size prefix.</summary>
+struct bodyEntry
+{
+	uint32_t offset = 0; // The size prefix
+	uint32_t size = 0;
+	uint32_t locals = 0; // The locals declaration, which is where the body proper starts
+	uint32_t code = 0; // The first instruction
+};
+
+///	<summary>
+///	Where every body of the code section is, so a single function can be found
+///	without walking the ones before it. Building it reads only the size prefix and
+///	the locals declaration of each body and jumps over the instructions.<br>
+///	Entries are in code section order, which is function index order starting after
+///	the imported functions, and their offsets grow with the index, so the body
+///	holding any file offset is a binary search away.<br>
+///	An index can be saved next to the module and loaded again instead of scanning.
+///	It remembers where the code section was, and won't load for a different layout.
+///	</summary>
+class BodyIndex
+{
+public:
+	static BodyIndex build(const std::vector<byte>& section, uint32_t sectionOffset);
+	static BodyIndex load(const std::string& filename);
+	void save(const std::string& filename) const;
+
+	size_t size() const;
+	const bodyEntry& at(size_t index) const;
+	int find(uint32_t fileOffset) const;
+	bool matches(uint32_t offset, uint32_t length) const;
+	bool isComplete() const;
+
+private:
+	std::vector<bodyEntry> bodies;
+	uint32_t sectionOffset = 0;
+	uint32_t sectionLength = 0;
+	uint32_t declared = 0; // How many bodies the section says it has
+};
+
+#endif // BODYINDEX_H
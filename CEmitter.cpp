@@ -0,0 +1,566 @@
+#include "CEmitter.h"
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+///	<summary>How a two operand instruction is written in C. Unsigned operations cast
+///	their operands, as wasm integers carry no sign of their own.</summary>
+struct cOperator
+{
+	const char* text;
+	bool isUnsigned;
+};
+
+static const cOperator integerCompare[] = {
+	{ "==", false }, { "!=", false }, { "<", false }, { "<", true }, { ">", false },
+	{ ">", true }, { "<=", false }, { "<=", true }, { ">=", false }, { ">=", true } };
+static const cOperator integerArithmetic[] = {
+	{ "+", false }, { "-", false }, { "*", false }, { "/", false }, { "/", true }, { "%", false },
+	{ "%", true }, { "&", false }, { "|", false }, { "^", false }, { "<<", false }, { ">>", false }, { ">>", true } };
+static const char* floatCompare[] = { "==", "!=", "<", ">", "<=", ">=" };
+static const char* floatArithmetic[] = { "+", "-", "*", "/" };
+
+///	<summary>Finds the infix operator of an instruction, and the type its operands are
+///	cast to if it is unsigned. Returns false if the instruction isn't one.</summary>
+static bool infixOperator(byte op, cOperator& result, const char*& unsignedCast)
+{
+	unsignedCast = (op >= 0x51 && op <= 0x5a) || (op >= 0x7c && op <= 0x88) ? "(uint64_t)" : "(uint32_t)";
+	if (op >= 0x46 && op <= 0x4f)
+		result = integerCompare[op - 0x46];
+	else if (op >= 0x6a && op <= 0x76)
+		result = integerArithmetic[op - 0x6a];
+	else if (op >= 0x51 && op <= 0x5a)
+		result = integerCompare[op - 0x51];
+	else if (op >= 0x7c && op <= 0x88)
+		result = integerArithmetic[op - 0x7c];
+	else if (op >= 0x5b && op <= 0x60)
+		result = cOperator{ floatCompare[op - 0x5b], false };
+	else if (op >= 0x61 && op <= 0x66)
+		result = cOperator{ floatCompare[op - 0x61], false };
+	else if (op >= 0x92 && op <= 0x95)
+		result = cOperator{ floatArithmetic[op - 0x92], false };
+	else if (op >= 0xa0 && op <= 0xa3)
+		result = cOperator{ floatArithmetic[op - 0xa0], false };
+	else
+		return false;
+	return true;
+}
+
+///	<summary>Conversions that C writes as a cast.</summary>
+static const char* castOf(byte op)
+{
+	switch (op)
+	{
+	case 0xa7: case 0xa8: case 0xaa: return "(int32_t)";
+	case 0xa9: case 0xab: return "(uint32_t)";
+	case 0xac: case 0xae: case 0xb0: return "(int64_t)";
+	case 0xad: return "(int64_t)(uint32_t)";
+	case 0xaf: case 0xb1: return "(uint64_t)";
+	case 0xb2: case 0xb4: case 0xb6: return "(float)";
+	case 0xb3: return "(float)(uint32_t)";
+	case 0xb5: return "(float)(uint64_t)";
+	case 0xb7: case 0xb9: case 0xbb: return "(double)";
+	case 0xb8: return "(double)(uint32_t)";
+	case 0xba: return "(double)(uint64_t)";
+	case 0xc0: return "(int32_t)(int8_t)";
+	case 0xc1: return "(int32_t)(int16_t)";
+	case 0xc2: return "(int64_t)(int8_t)";
+	case 0xc3: return "(int64_t)(int16_t)";
+	case 0xc4: return "(int64_t)(int32_t)";
+	default: return nullptr;
+	}
+}
+
+///	<summary>Operations C only has as a library function (or a common builtin).</summary>
+static const char* functionOf(byte op)
+{
+	switch (op)
+	{
+	case 0x67: return "clz32";
+	case 0x68: return "ctz32";
+	case 0x69: return "popcount32";
+	case 0x77: return "rotl32";
+	case 0x78: return "rotr32";
+	case 0x79: return "clz64";
+	case 0x7a: return "ctz64";
+	case 0x7b: return "popcount64";
+	case 0x89: return "rotl64";
+	case 0x8a: return "rotr64";
+	case 0x8b: return "fabsf";
+	case 0x8d: return "ceilf";
+	case 0x8e: return "floorf";
+	case 0x8f: return "truncf";
+	case 0x90: return "nearbyintf";
+	case 0x91: return "sqrtf";
+	case 0x96: return "fminf";
+	case 0x97: return "fmaxf";
+	case 0x98: return "copysignf";
+	case 0x99: return "fabs";
+	case 0x9b: return "ceil";
+	case 0x9c: return "floor";
+	case 0x9d: return "trunc";
+	case 0x9e: return "nearbyint";
+	case 0x9f: return "sqrt";
+	case 0xa4: return "fmin";
+	case 0xa5: return "fmax";
+	case 0xa6: return "copysign";
+	default: return nullptr;
+	}
+}
+
+///	<summary>The C type a load or store goes through.</summary>
+static const char* pointeeType(const char* pointee)
+{
+	const std::string name = pointee;
+	if (name == "i8") return "int8_t";
+	if (name == "u8") return "uint8_t";
+	if (name == "i16") return "int16_t";
+	if (name == "u16") return "uint16_t";
+	if (name == "i32") return "int32_t";
+	if (name == "u32") return "uint32_t";
+	if (name == "i64") return "int64_t";
+	if (name == "f32") return "float";
+	if (name == "f64") return "double";
+	return "v128_t";
+}
+
+///	<summary>Writes a float so it reads back as the same value.</summary>
+static std::string floatLiteral(double value, bool single)
+{
+	if (std::isnan(value))
+		return "NAN";
+	if (std::isinf(value))
+		return value < 0 ? "-INFINITY" : "INFINITY";
+
+	std::ostringstream ss;
+	ss << std::setprecision(single ? std::numeric_limits<float>::max_digits10 : std::numeric_limits<double>::max_digits10) << value;
+	std::string text = ss.str();
+	if (text.find_first_of(".e") == std::string::npos)
+		text += ".0";
+	return single ? text + 'f' : text;
+}
+
+const char* CEmitter::name() const
+{
+	return "c";
+}
+
+const char* CEmitter::cType(dataTypes type)
+{
+	switch (type)
+	{
+	case i32: return "int32_t";
+	case i64: return "int64_t";
+	case f32: return "float";
+	case f64: return "double";
+	case v128: return "v128_t";
+	default: return "void";
+	}
+}
+
+void CEmitter::beginFunction(emitState& state, std::string& out) const
+{
+	const Function& func = state.func;
+	const signature& sig = func.getSignature();
+
+	out += cType(sig.output.type);
+	out += ' ';
+	if (!func.getTitle().empty())
+		out += identifier(std::string(func.getTitle()));
+	else
+		out += state.index >= 0 ? identifier(functionName(state.index)) : "func";
+	out += '(';
+
+	for (size_t i = 0; i < sig.inputs.size(); ++i)
+	{
+		if (i != 0)
+			out += ", ";
+		out += std::string(cType(sig.inputs[i].type)) + ' ' + localName(func, (uint32_t)i);
+	}
+	if (sig.inputs.empty())
+		out += "void";
+	out += ")\n{\n";
+
+	// Locals start at zero in wasm. Long runs are shortened like in the default format.
+	for (const auto& run : func.getLocals())
+	{
+		if (run.count == 0)
+			continue;
+
+		indent(1, out);
+		out += std::string(cType(run.type)) + ' ';
+		if (run.count <= 8)
+		{
+			for (uint32_t i = 0; i < run.count; ++i)
+				out += (i != 0 ? ", " : "") + localName(func, run.first + i) + " = 0";
+			out += ";\n";
+		}
+		else
+		{
+			out += localName(func, run.first) + " ... " + localName(func, run.first + run.count - 1)
+				+ "; // " + std::to_string(run.count) + " locals, all 0\n";
+		}
+	}
+}
+
+void CEmitter::endFunction(emitState& /*state*/, std::string& out) const
+{
+	out += "}\n";
+}
+
+///	<summary>Blocks open a scope. A loop that is branched to gets its label in front,
+///	as branching to a loop starts it over. A block with a result declares the variable
+///	it leaves its result in first.</summary>
+void CEmitter::openBlock(const statement* node, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	const dataTypes result = state.func.getBlockResult(node->operation);
+	if (result != none)
+	{
+		out += std::string(cType(result)) + ' ' + resultName(node->offset) + ";\n";
+		indent(state.depth(), out);
+	}
+
+	const byte op = node->operation.op.op;
+	if (op == 0x03 && state.targets.count(node->offset))
+		out += "L" + std::to_string(node->offset) + ": ";
+
+	if (op == 0x04)
+		out += "if (" + (node->leftOperand != nullptr ? expression(node->leftOperand, state) : std::string("?")) + ") ";
+	out += "{\n";
+}
+
+void CEmitter::elseBlock(const statement* /*node*/, emitState& state, std::string& out) const
+{
+	indent(state.depth() - 1, out);
+	out += "} else {\n";
+}
+
+///	<summary>Blocks and ifs that are branched to get their label after the closing brace.</summary>
+void CEmitter::closeBlock(const statement* opener, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	out += "}\n";
+
+	if (opener != nullptr && opener->operation.op.op != 0x03 && state.targets.count(opener->offset))
+	{
+		indent(state.depth(), out);
+		out += "L" + std::to_string(opener->offset) + ":;\n";
+	}
+}
+
+void CEmitter::blockValue(const statement* value, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	out += resultName(state.open.back()->offset) + " = " + expression(value, state) + ";\n";
+}
+
+void CEmitter::line(const statement* node, const statement* next, emitState& state, std::string& out) const
+{
+	const byte op = node->operation.op.op;
+	if (op == 0x01) // nop
+		return;
+
+	std::string text;
+	switch (op)
+	{
+	case 0x00:
+		text = "abort()";
+		break;
+	case 0x0c:
+	{
+		auto targets = labels(node);
+		const std::string value = node->rightOperand != nullptr ? expression(node->rightOperand, state) : "";
+		text = branch(targets.empty() ? 0 : targets[0], value, state);
+		break;
+	}
+	case 0x0d:
+	{
+		// The value a br_if carries is also what it leaves when it doesn't branch, so it
+		// goes in a variable first
+		auto targets = labels(node);
+		const uint32_t label = targets.empty() ? 0 : targets[0];
+		std::string value;
+		if (node->rightOperand != nullptr)
+		{
+			value = carriedName(node->offset);
+			indent(state.depth(), out);
+			out += std::string(cType(branchType(label, state))) + ' ' + value + " = " + expression(node->rightOperand, state) + ";\n";
+		}
+		text = "if (" + (node->leftOperand != nullptr ? expression(node->leftOperand, state) : std::string("?")) + ") "
+			+ guarded(branch(label, value, state));
+		break;
+	}
+	case 0x0e:
+	{
+		// The last label is the default, and cases going to the same place are left out.
+		// A value carried to several places is worked out once.
+		auto targets = labels(node);
+		std::string value;
+		if (node->rightOperand != nullptr)
+		{
+			value = carriedName(node->offset);
+			indent(state.depth(), out);
+			out += std::string(cType(branchType(targets.empty() ? 0 : targets.back(), state))) + ' ' + value + " = "
+				+ expression(node->rightOperand, state) + ";\n";
+		}
+		text = "switch (" + (node->leftOperand != nullptr ? expression(node->leftOperand, state) : std::string("?")) + ") {";
+		for (size_t i = 0; i + 1 < targets.size(); ++i)
+		{
+			if (targets[i] != targets.back())
+				text += " case " + std::to_string(i) + ": " + branch(targets[i], value, state) + ';';
+		}
+		if (!targets.empty())
+			text += " default: " + branch(targets.back(), value, state) + ';';
+		text += " }";
+		indent(state.depth(), out);
+		out += text + '\n';
+		return;
+	}
+	case 0x0f:
+		text = "return";
+		break;
+	case 0x1a: // drop evaluates its operand for the side effects
+		text = node->leftOperand != nullptr ? expression(node->leftOperand, state) : "";
+		break;
+	case 0x21:
+	case 0x24:
+	{
+		int idx;
+		getNextu32(node->operation.bytes, 0, idx);
+		text = (op == 0x21 ? localName(state.func, idx) : "g" + std::to_string(idx)) + " = "
+			+ (node->leftOperand != nullptr ? expression(node->leftOperand, state) : std::string("?"));
+		break;
+	}
+	default:
+	{
+		text = expression(node, state);
+
+		// A value followed by a return, or left at the end of the function, is what it returns
+		const bool returnsValue = state.func.getSignature().output.type != none;
+		if (node->producesValue && returnsValue && ((next != nullptr && next->operation.op.op == 0x0f)
+			|| (next == nullptr && state.open.empty())))
+		{
+			text = "return " + text;
+			state.skipNext = next != nullptr;
+		}
+		break;
+	}
+	}
+
+	indent(state.depth(), out);
+	out += text;
+	if (text.empty() || text.back() != '}')
+		out += ';';
+
+	const std::string comment = notes(node);
+	if (!comment.empty())
+		out += " // " + comment;
+	out += '\n';
+}
+
+///	<summary>What a branch to a label does: a goto, or a return when it leaves the function.
+///	The value it carries is returned, or put in the variable of the block it goes to.
+///	'value' is empty when the branch doesn't carry one.</summary>
+std::string CEmitter::branch(uint32_t label, const std::string& value, const emitState& state) const
+{
+	const std::string carried = value.empty() ? "/* value */" : value;
+	const statement* target = state.target(label);
+	if (target == nullptr)
+		return state.func.getSignature().output.type == none ? "return" : "return " + carried;
+
+	const std::string jump = "goto L" + std::to_string(target->offset);
+	if (target->operation.op.op == 0x03 || state.func.getBlockResult(target->operation) == none)
+		return jump;
+	return resultName(target->offset) + " = " + carried + "; " + jump;
+}
+
+///	<summary>The type of the value a branch to a label carries, or none.</summary>
+dataTypes CEmitter::branchType(uint32_t label, const emitState& state)
+{
+	const statement* target = state.target(label);
+	if (target == nullptr)
+		return state.func.getSignature().output.type;
+	return target->operation.op.op == 0x03 ? none : state.func.getBlockResult(target->operation);
+}
+
+///	<summary>Puts braces around a branch that takes more than one statement, so it can follow an if.</summary>
+std::string CEmitter::guarded(const std::string& jump)
+{
+	return jump.find(';') == std::string::npos ? jump : "{ " + jump + "; }";
+}
+
+///	<summary>Renders a value producing statement. Nested operations are bracketed so the
+///	reader never has to think about C's precedence rules.</summary>
+std::string CEmitter::expression(const statement* node, const emitState& state, bool nested) const
+{
+	static thread_local int depth = 0;
+	const depthGuard guard(depth);
+	if (guard.tooDeep())
+		return "/* ... */";
+
+	const opcodes::ins& ins = node->operation.op;
+	const byte op = ins.op;
+	const auto ops = operands(node);
+	auto operand = [&](size_t i) { return i < ops.size() ? expression(ops[i], state, true) : std::string("?"); };
+	auto bracket = [&](const std::string& text) { return nested ? '(' + text + ')' : text; };
+
+	// Constants
+	if (op == 0x41 || op == 0x42)
+	{
+		int64_t value;
+		getNexts64(node->operation.bytes, 0, value);
+		return std::to_string(op == 0x41 ? (int64_t)(int32_t)value : value);
+	}
+	if (op == 0x43 || op == 0x44)
+	{
+		const auto& bytes = node->operation.bytes;
+		char raw[8] = {};
+		for (size_t i = 0; i < bytes.size() && i < 8; ++i)
+			raw[i] = bytes[i];
+		return op == 0x43 ? floatLiteral(decodeFloat(raw), true) : floatLiteral(decodeDouble(raw), false);
+	}
+
+	// Values the decoder stands in for are in variables, named after the block or br_if
+	// that starts right before them
+	if (op == opcodes::blockResult.op)
+		return resultName(node->offset - 1);
+	if (op == opcodes::branchValue.op)
+		return carriedName(node->offset - 1);
+
+	// Variables
+	if (op >= 0x20 && op <= 0x23)
+	{
+		int idx;
+		getNextu32(node->operation.bytes, 0, idx);
+		if (op == 0x23)
+			return "g" + std::to_string(idx);
+		if (op == 0x22)
+			return bracket(localName(state.func, idx) + " = " + operand(0));
+		return localName(state.func, idx);
+	}
+
+	// Loads and stores go through a typed pointer
+	const opcodes::memoryAccess access = opcodes::accessOf(ins);
+	if (access.pointee != nullptr)
+	{
+		std::string pointer = std::string("*(") + pointeeType(access.pointee) + "*)(";
+		if (!ops.empty() && ops[0]->operation.op.op == 0x41)
+		{
+			// A constant address is a plain number, with the offset already added in
+			int64_t base;
+			getNexts64(ops[0]->operation.bytes, 0, base);
+			pointer += std::to_string((uint64_t)(uint32_t)base + node->operation.mem.offset);
+		}
+		else
+		{
+			pointer += !ops.empty() ? expression(ops[0], state) : "?";
+			if (node->operation.mem.offset != 0)
+				pointer += " + " + std::to_string(node->operation.mem.offset);
+		}
+		pointer += ')';
+
+		if (!access.store)
+			return pointer;
+		return pointer + " = " + (ops.size() > 1 ? expression(ops[1], state) : std::string("?"));
+	}
+
+	// Calls. An indirect call takes the table slot last.
+	if (op == 0x10 || op == 0x11)
+	{
+		int idx;
+		getNextu32(node->operation.bytes, 0, idx);
+		size_t count = ops.size();
+		std::string callee = identifier(functionName(idx));
+		if (op == 0x11)
+		{
+			callee = "table[" + (count != 0 ? expression(ops[count - 1], state) : std::string("?")) + "]";
+			if (count != 0)
+				count--;
+		}
+
+		std::string text = callee + '(';
+		for (size_t i = 0; i < count; ++i)
+			text += (i != 0 ? ", " : "") + expression(ops[i], state);
+		return text + ')';
+	}
+
+	// select picks the first value when the condition isn't zero
+	if (op == 0x1b || op == 0x1c)
+		return bracket(operand(2) + " ? " + operand(0) + " : " + operand(1));
+
+	cOperator infix;
+	const char* unsignedCast;
+	if (ops.size() == 2 && infixOperator(op, infix, unsignedCast))
+	{
+		const std::string cast = infix.isUnsigned ? unsignedCast : "";
+		return bracket(cast + operand(0) + ' ' + infix.text + ' ' + cast + operand(1));
+	}
+
+	if (op == 0x45 || op == 0x50)
+		return '!' + operand(0);
+	if (op == 0x8c || op == 0x9a)
+		return '-' + operand(0);
+	if (const char* cast = castOf(op))
+		return cast + operand(0);
+
+	// Everything else is written as a call, immediates after the operands
+	const char* function = functionOf(op);
+	std::string text = function != nullptr ? function : ins.symbol;
+	text += '(';
+	std::vector<std::string> parts;
+	for (const statement* value : ops)
+		parts.push_back(expression(value, state));
+
+	if (ins.imm == opcodes::immV128 || ins.imm == opcodes::immLane)
+	{
+		for (byte raw : node->operation.bytes)
+			parts.push_back(std::to_string(raw));
+	}
+	else if (op != 0x3f && op != 0x40) // memory.size and grow only have a reserved byte
+	{
+		for (uint32_t value : immediates(node))
+			parts.push_back(std::to_string(value));
+	}
+
+	for (size_t i = 0; i < parts.size(); ++i)
+		text += (i != 0 ? ", " : "") + parts[i];
+	return text + ')';
+}
+
+///	<summary>The variable a block with a result leaves it in, named after where the block starts like its label.</summary>
+std::string CEmitter::resultName(int blockOffset)
+{
+	return "block" + std::to_string(blockOffset);
+}
+
+///	<summary>The variable a branch keeps the value it carries in.</summary>
+std::string CEmitter::carriedName(int branchOffset)
+{
+	return "value" + std::to_string(branchOffset);
+}
+
+///	<summary>A name as a C identifier. Imports are named "module::field", and export names
+///	can hold anything, so every character C doesn't allow becomes an underscore.</summary>
+std::string CEmitter::identifier(const std::string& name)
+{
+	std::string result;
+	result.reserve(name.size() + 1);
+	for (size_t i = 0; i < name.size(); ++i)
+	{
+		if (name.compare(i, 2, "::") == 0)
+		{
+			result += '_';
+			i++;
+			continue;
+		}
+
+		const char c = name[i];
+		const bool allowed = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+		result += allowed ? c : '_';
+	}
+
+	if (result.empty() || (result[0] >= '0' && result[0] <= '9'))
+		result.insert(result.begin(), '_');
+	return result;
+}
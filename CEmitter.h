@@ -0,0 +1,38 @@
+#ifndef CEMITTER_H
+#define CEMITTER_H
+#include "Emitter.h"
+
+///	<summary>
+///	Renders functions as C-like code: infix operators with C precedence kept
+///	explicit by brackets, casts where wasm picks the signed or unsigned form of
+///	an operation, and memory accesses as pointer dereferences.<br>
+///	Control flow stays as structured as the binary: blocks become braces, and
+///	branches become gotos to a label placed after the block (or before the loop)
+///	they leave. Labels are only printed when something branches to them.
+///	</summary>
+class CEmitter : public Emitter
+{
+public:
+	const char* name() const override;
+
+protected:
+	void beginFunction(emitState& state, std::string& out) const override;
+	void endFunction(emitState& state, std::string& out) const override;
+	void openBlock(const statement* node, emitState& state, std::string& out) const override;
+	void elseBlock(const statement* node, emitState& state, std::string& out) const override;
+	void closeBlock(const statement* opener, emitState& state, std::string& out) const override;
+	void blockValue(const statement* value, emitState& state, std::string& out) const override;
+	void line(const statement* node, const statement* next, emitState& state, std::string& out) const override;
+
+private:
+	std::string expression(const statement* node, const emitState& state, bool nested = false) const;
+	std::string branch(uint32_t label, const std::string& value, const emitState& state) const;
+	static dataTypes branchType(uint32_t label, const emitState& state);
+	static std::string guarded(const std::string& jump);
+	static const char* cType(dataTypes type);
+	static std::string identifier(const std::string& name);
+	static std::string resultName(int blockOffset);
+	static std::string carriedName(int branchOffset);
+};
+
+#endif // CEMITTER_H
@@ -0,0 +1,130 @@
+#include "DataSegments.h"
+#include <iterator>
+
+// Strings longer than this are cut short. Nobody reads a literal that long in a listing.
+static const uint32_t longestString = 256;
+
+///	<summary>Takes the raw data section and the segments found in it, and lays the
+///	placed segments of memory 0 out in section order.</summary>
+DataSegments::DataSegments(std::vector<byte> section, std::vector<dataSegment> segments)
+	: bytes(std::move(section)), segments(std::move(segments))
+{
+	for (uint32_t i = 0; i < this->segments.size(); ++i)
+	{
+		const dataSegment& segment = this->segments[i];
+		if (segment.start + (uint64_t)segment.length > bytes.size())
+			throw std::exception("Data segment runs past the end of the data section");
+
+		if (segment.placed && segment.memory == 0 && segment.length != 0)
+			place(i);
+	}
+}
+
+const std::vector<dataSegment>& DataSegments::getSegments() const
+{
+	return segments;
+}
+
+///	<summary>Puts a segment in the interval map, cutting away whatever it covers of the
+///	segments placed before it.</summary>
+void DataSegments::place(uint32_t index)
+{
+	const uint64_t from = segments[index].address;
+	const uint64_t to = from + segments[index].length;
+
+	// A span starting before this one may reach into it, or even past it
+	auto it = spans.lower_bound(from);
+	if (it != spans.begin())
+	{
+		auto before = std::prev(it);
+		if (before->second.to > from)
+		{
+			const span old = before->second;
+			before->second.to = from;
+			if (old.to > to)
+				spans.emplace(to, old);
+		}
+	}
+
+	// Spans starting inside this one are hidden, apart from any part sticking out the end
+	while (it != spans.end() && it->first < to)
+	{
+		if (it->second.to > to)
+		{
+			const span rest = it->second;
+			spans.erase(it);
+			spans.emplace(to, rest);
+			break;
+		}
+		it = spans.erase(it);
+	}
+
+	spans[from] = span{ to, index };
+}
+
+///	<summary>The visible span covering an address, or nullptr if no segment puts anything there.</summary>
+const DataSegments::span* DataSegments::spanAt(uint32_t address) const
+{
+	auto it = spans.upper_bound(address);
+	if (it == spans.begin())
+		return nullptr;
+
+	--it;
+	if (address >= it->second.to)
+		return nullptr;
+
+	return &it->second;
+}
+
+///	<summary>The segment whose bytes end up at 'address' of memory 0, if any.</summary>
+const dataSegment* DataSegments::find(uint32_t address) const
+{
+	const span* found = spanAt(address);
+	return found != nullptr ? &segments[found->segment] : nullptr;
+}
+
+///	<summary>Reads the text starting at 'address', if it looks like a string: printable
+///	characters up to a terminating zero, or up to the end of the data when there are
+///	enough of them. Text carries on into the next segment when that one starts right
+///	where the current one stops. Gives false for anything else.</summary>
+bool DataSegments::stringAt(uint32_t address, std::string& out) const
+{
+	auto it = spans.upper_bound(address);
+	if (it == spans.begin())
+		return false;
+	--it;
+
+	out.clear();
+	uint64_t at = address;
+	bool terminated = false;
+	while (!terminated && it != spans.end() && it->first <= at && at < it->second.to && out.size() <= longestString)
+	{
+		const dataSegment& segment = segments[it->second.segment];
+		const byte* text = &bytes[segment.start];
+		for (; at < it->second.to && out.size() <= longestString; ++at)
+		{
+			if (at - segment.address >= segment.length)
+				return false;
+			const byte c = text[at - segment.address];
+			if (c == 0)
+			{
+				terminated = true;
+				break;
+			}
+			if ((c < 0x20 && c != '\t' && c != '\n' && c != '\r') || c == 0x7f)
+				return false;
+			out += (char)c;
+		}
+		++it;
+	}
+
+	if (out.empty() || (!terminated && out.size() < 4))
+		return false;
+
+	if (out.size() > longestString)
+	{
+		out.resize(longestString);
+		out += "...";
+	}
+	return true;
+}
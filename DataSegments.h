@@ -0,0 +1,56 @@
+#ifndef DATASEGMENTS_H
+#define DATASEGMENTS_H
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+typedef unsigned char byte;
+
+///	<summary>One entry of the data section. The bytes aren't copied out: 'start' is
+///	where they begin in the section.</summary>
+struct dataSegment
+{
+	uint32_t memory = 0;
+	uint32_t address = 0; // Where the bytes are placed in memory. Only meaningful when 'placed'.
+	uint32_t start = 0;
+	uint32_t length = 0;
+	bool placed = false; // Passive segments, and ones placed by an imported global, have no known address
+};
+
+///	<summary>
+///	The initial contents of memory, as laid down by the data section. The section
+///	is kept whole and the segments only point into it, so nothing is copied per
+///	segment.<br>
+///	Placed segments are indexed by address in an interval map. A later segment
+///	overwrites whatever an earlier one put at the same addresses, so the map holds
+///	the spans that are left visible, and finding the bytes behind an address is a
+///	single lookup. Strings are only read out of it when something asks for one.
+///	</summary>
+class DataSegments
+{
+public:
+	DataSegments() = default;
+	DataSegments(std::vector<byte> section, std::vector<dataSegment> segments);
+
+	const std::vector<dataSegment>& getSegments() const;
+	const dataSegment* find(uint32_t address) const;
+	bool stringAt(uint32_t address, std::string& out) const;
+
+private:
+	///	<summary>Addresses from the key of the span up to 'to' show the bytes of 'segment'.</summary>
+	struct span
+	{
+		uint64_t to;
+		uint32_t segment;
+	};
+
+	void place(uint32_t index);
+	const span* spanAt(uint32_t address) const;
+
+	std::vector<byte> bytes; // The whole data section
+	std::vector<dataSegment> segments;
+	std::map<uint64_t, span> spans; // Keyed by the first address of the span. Segments may run past 4 GiB.
+};
+
+#endif // DATASEGMENTS_H
@@ -0,0 +1,283 @@
+#include "Emitter.h"
+#include <algorithm>
+
+///	<summary>The indentation of a statement in the current block. The body of the
+///	function is at depth 1.</summary>
+int emitState::depth() const
+{
+	return (int)open.size() + 1;
+}
+
+///	<summary>The block a branch label refers to: 0 is the innermost open block.
+///	Gives nullptr when the label refers to the function body itself.</summary>
+const statement* emitState::target(uint32_t label) const
+{
+	if (label >= open.size())
+		return nullptr;
+
+	return open[open.size() - 1 - label];
+}
+
+///	<summary>Renders one function onto the end of 'out'.</summary>
+void Emitter::emit(const Function& func, int index, std::string& out) const
+{
+	emitState state(func, index);
+
+	// A first pass finds the blocks that are branched to, so backends that need
+	// labels only print the ones that are used.
+	for (const statement* node : func.statements)
+	{
+		const byte op = node->operation.op.op;
+		if (op >= 0x02 && op <= 0x04)
+			state.open.push_back(node);
+		else if (op == 0x0b && !state.open.empty())
+			state.open.pop_back();
+		else if (op >= 0x0c && op <= 0x0e)
+		{
+			for (uint32_t label : labels(node))
+			{
+				if (const statement* target = state.target(label))
+					state.targets.insert(target->offset);
+			}
+		}
+	}
+	state.open.clear();
+
+	beginFunction(state, out);
+	for (size_t i = 0; i < func.statements.size(); ++i)
+	{
+		if (state.skipNext)
+		{
+			state.skipNext = false;
+			continue;
+		}
+
+		const statement* node = func.statements[i];
+		const byte op = node->operation.op.op;
+		if (op >= 0x02 && op <= 0x04)
+		{
+			openBlock(node, state, out);
+			state.open.push_back(node);
+			state.openIfs += op == 0x04 ? 1 : 0;
+		}
+		else if (op == 0x05)
+		{
+			if (node->leftOperand != nullptr)
+				blockValue(node->leftOperand, state, out);
+			elseBlock(node, state, out);
+		}
+		else if (op == 0x0b)
+		{
+			if (node->leftOperand != nullptr)
+				blockValue(node->leftOperand, state, out);
+
+			const statement* opener = nullptr;
+			if (!state.open.empty())
+			{
+				opener = state.open.back();
+				state.open.pop_back();
+				state.openIfs -= opener->operation.op.op == 0x04 ? 1 : 0;
+			}
+			closeBlock(opener, state, out);
+		}
+		else if (op == 0xef)
+			decodeFailure(node, state, out);
+		else
+		{
+			const statement* next = i + 1 < func.statements.size() ? func.statements[i + 1] : nullptr;
+			line(node, next, state, out);
+		}
+	}
+
+	// A body that failed to decode can stop inside blocks, which still get closed
+	while (!state.open.empty())
+	{
+		const statement* opener = state.open.back();
+		state.open.pop_back();
+		state.openIfs -= opener->operation.op.op == 0x04 ? 1 : 0;
+		closeBlock(opener, state, out);
+	}
+	endFunction(state, out);
+}
+
+///	<summary>Marks where a malformed body stopped decoding. The default is a C style comment.</summary>
+void Emitter::decodeFailure(const statement* node, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	out += "// could not decode past offset " + std::to_string(node->offset) + ": " + state.func.getError() + '\n';
+}
+
+///	<summary>Gives the emitter the names of the module's functions, so calls can use them.</summary>
+void Emitter::setFunctionNames(std::vector<std::string_view> names)
+{
+	funcNames = std::move(names);
+}
+
+///	<summary>Gives the emitter the module's data segments, so constants pointing at strings
+///	can be shown with the string.</summary>
+void Emitter::setDataSegments(const DataSegments* segments)
+{
+	data = segments;
+}
+
+///	<summary>Gives the emitter the module's tables, so indirect calls can list where they may go.</summary>
+void Emitter::setIndirectTable(const IndirectTable* table)
+{
+	indirect = table;
+}
+
+///	<summary>The name a call to a function index is shown with.</summary>
+std::string Emitter::functionName(uint32_t index) const
+{
+	if (index < funcNames.size() && !funcNames[index].empty())
+		return std::string(funcNames[index]);
+
+	return "func_" + std::to_string(index);
+}
+
+///	<summary>Indents a line. Past a point the indentation stops growing: nesting that deep
+///	can't be read anyway, and the output would grow with the square of it.</summary>
+void Emitter::indent(int depth, std::string& out)
+{
+	static const int deepest = 64;
+	out.append(depth > 0 ? std::min(depth, deepest) : 0, '\t');
+}
+
+///	<summary>The branch labels of a br, br_if or br_table. For a br_table the default
+///	label comes last.</summary>
+std::vector<uint32_t> Emitter::labels(const statement* node)
+{
+	std::vector<uint32_t> result;
+	const auto& bytes = node->operation.bytes;
+	int offset = 0;
+	int count = 1;
+	if (node->operation.op.op == 0x0e && !bytes.empty())
+	{
+		offset += getNextu32(bytes, 0, count);
+		count++;
+	}
+
+	for (int i = 0; i < count && offset < (int)bytes.size(); ++i)
+	{
+		int label;
+		offset += getNextu32(bytes, offset, label);
+		result.push_back((uint32_t)label);
+	}
+	return result;
+}
+
+///	<summary>The operands of a statement in the order they were pushed, which is the order
+///	they are written in. Two operand instructions keep the first one on the right.</summary>
+std::vector<const statement*> Emitter::operands(const statement* node)
+{
+	if (!node->arguments.empty())
+		return std::vector<const statement*>(node->arguments.begin(), node->arguments.end());
+
+	std::vector<const statement*> result;
+	if (node->rightOperand != nullptr)
+		result.push_back(node->rightOperand);
+	if (node->leftOperand != nullptr)
+		result.push_back(node->leftOperand);
+	return result;
+}
+
+///	<summary>The LEB immediates of a statement as numbers. A vector's length is left out.</summary>
+std::vector<uint32_t> Emitter::immediates(const statement* node)
+{
+	std::vector<uint32_t> result;
+	const auto& bytes = node->operation.bytes;
+	int offset = 0;
+	if (node->operation.op.associatedBytes == 0xff && !bytes.empty())
+	{
+		int length;
+		offset += getNextu32(bytes, 0, length);
+	}
+
+	while (offset < (int)bytes.size())
+	{
+		int value;
+		offset += getNextu32(bytes, offset, value);
+		result.push_back((uint32_t)value);
+	}
+	return result;
+}
+
+///	<summary>The name of a local: parameters keep their signature names, and the declared
+///	locals are named after their type and index, as in the locals declaration.</summary>
+std::string Emitter::localName(const Function& func, uint32_t idx)
+{
+	const auto& inputs = func.getSignature().inputs;
+	if (idx < inputs.size() && !inputs[idx].name.empty())
+		return std::string(inputs[idx].name);
+
+	return std::string("__") + typeName(func.getLocalType(idx)) + "_local_" + std::to_string(idx);
+}
+
+///	<summary>What a line refers to that isn't written in it: the strings that i32 constants
+///	point at, and the functions an indirect call can reach. Empty when there is nothing
+///	to say. The module's data and tables are only looked at here, so lines without such
+///	instructions cost nothing extra.</summary>
+std::string Emitter::notes(const statement* node) const
+{
+	// Nobody reads a list of a thousand vtable entries, so long ones are cut short
+	static const size_t listedTargets = 8;
+
+	std::string result;
+	std::vector<const statement*> pending{ node };
+	while (!pending.empty())
+	{
+		const statement* next = pending.back();
+		pending.pop_back();
+		if (next == nullptr)
+			continue;
+
+		std::string note;
+		const byte op = next->operation.op.op;
+		int64_t value = 0;
+		std::string text;
+		if (op == 0x41 && data != nullptr && !next->operation.bytes.empty())
+			getNexts64(next->operation.bytes, 0, value);
+
+		if (op == 0x41 && data != nullptr && data->stringAt((uint32_t)value, text))
+		{
+			note += '"';
+			for (char c : text)
+			{
+				switch (c)
+				{
+				case '"': note += "\\\""; break;
+				case '\\': note += "\\\\"; break;
+				case '\n': note += "\\n"; break;
+				case '\r': note += "\\r"; break;
+				case '\t': note += "\\t"; break;
+				default: note += c;
+				}
+			}
+			note += '"';
+		}
+		else if (op == 0x11 && indirect != nullptr)
+		{
+			const auto values = immediates(next);
+			const auto& targets = indirect->candidates(values.size() > 1 ? values[1] : 0, values.empty() ? TypeTable::noType : values[0]);
+			if (targets.empty())
+				note = "calls nothing in the table";
+			else
+			{
+				note = targets.size() == 1 ? "calls " : "calls one of ";
+				for (size_t i = 0; i < targets.size() && i < listedTargets; ++i)
+					note += (i == 0 ? "" : ", ") + functionName(targets[i]);
+				if (targets.size() > listedTargets)
+					note += " and " + std::to_string(targets.size() - listedTargets) + " more";
+			}
+		}
+
+		if (!note.empty())
+			result += (result.empty() ? "" : "; ") + note;
+
+		// Operands are pushed in reverse, so the notes come out in the order the operands are written
+		const auto values = operands(next);
+		for (auto it = values.rbegin(); it != values.rend(); ++it)
+			pending.push_back(*it);
+	}
+	return result;
+}
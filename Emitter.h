@@ -0,0 +1,72 @@
+#ifndef EMITTER_H
+#define EMITTER_H
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+#include "Function.h"
+#include "DataSegments.h"
+#include "IndirectTable.h"
+
+///	<summary>What an emitter knows while it walks one function. Everything that changes
+///	during the walk lives here rather than in the emitter, so emitters stay read-only.</summary>
+struct emitState
+{
+	const Function& func;
+	int index; // Function index in the module, or -1 if unknown
+	std::vector<const statement*> open{}; // Blocks, loops and ifs around the current statement, innermost last
+	int openIfs = 0; // How many of 'open' are ifs
+	std::unordered_set<int> targets{}; // Offsets of the blocks and loops some branch goes to
+	bool skipNext = false; // Set by a backend that already covered the next statement
+
+	emitState(const Function& func, int index) : func(func), index(index) {}
+
+	int depth() const;
+	const statement* target(uint32_t label) const;
+};
+
+///	<summary>
+///	Turns decoded functions into text. The walk over a function's statements is
+///	shared, and a backend only decides how each piece looks: the function around
+///	the body, the block structure, the value a block with a result ends with
+///	(opcodes::blockResult stands for it after the block), and each statement.<br>
+///	emit() keeps its state on the stack and only appends to the buffer it is
+///	given, so a single emitter can be used from any number of threads at once,
+///	each rendering its own functions into its own buffer. Putting the buffers
+///	together in function order is left to the caller (see Mediator::emitFunctions).
+///	</summary>
+class Emitter
+{
+public:
+	virtual ~Emitter() = default;
+
+	void emit(const Function& func, int index, std::string& out) const;
+	void setFunctionNames(std::vector<std::string_view> names);
+	void setDataSegments(const DataSegments* segments);
+	void setIndirectTable(const IndirectTable* table);
+	virtual const char* name() const = 0;
+
+protected:
+	virtual void beginFunction(emitState& state, std::string& out) const = 0;
+	virtual void endFunction(emitState& state, std::string& out) const = 0;
+	virtual void openBlock(const statement* node, emitState& state, std::string& out) const = 0;
+	virtual void elseBlock(const statement* node, emitState& state, std::string& out) const = 0;
+	virtual void closeBlock(const statement* opener, emitState& state, std::string& out) const = 0;
+	virtual void blockValue(const statement* value, emitState& state, std::string& out) const = 0;
+	virtual void line(const statement* node, const statement* next, emitState& state, std::string& out) const = 0;
+	virtual void decodeFailure(const statement* node, emitState& state, std::string& out) const;
+
+	std::string functionName(uint32_t index) const;
+	static void indent(int depth, std::string& out);
+	static std::vector<uint32_t> labels(const statement* node);
+	static std::vector<const statement*> operands(const statement* node);
+	static std::vector<uint32_t> immediates(const statement* node);
+	static std::string localName(const Function& func, uint32_t idx);
+	std::string notes(const statement* node) const;
+
+	std::vector<std::string_view> funcNames{}; // Function index -> name, for calls
+	const DataSegments* data = nullptr; // The module's initial memory, for pointers to strings
+	const IndirectTable* indirect = nullptr; // The module's tables, for the targets of indirect calls
+};
+
+#endif // EMITTER_H
@@ -1,38 +1,138 @@
 #include "Function.h"
 #include "opcodes.h"
+#include "PseudoEmitter.h"
+#include <algorithm>
+#include <memory>
 
 
 ///	<summary>Default constructor. Nothing is set up.</summary>
 Function::Function()
 = default;
 
-///	<summary>Constructor that sets up the inputs and outputs.</summary>
-Function::Function(std::vector<dataDef> funcIns, dataDef& funcOuts)
+///	<summary>Constructor that gives the function its signature, as a canonical index
+///	into the module's shared type table.</summary>
+Function::Function(const TypeTable* table, uint32_t typeIdx)
+	: typeIdx(typeIdx), types(table)
 {
-	setInputs(funcIns);
-	setOutput(funcOuts);
 }
 
-///	<summary>Setter for the inputs of the function</summary>
-void Function::setInputs(std::vector<dataDef> ins)
+/// <summary>Setter that sets the internal title of the function.</summary>
+void Function::setTitle(std::string_view name)
 {
-	funcInputs = ins;
+	funcName = name;
 }
 
-/// <summary>Setter that sets outputs for the function.</summary>
-void Function::setOutput(dataDef& out)
+/// <summary>Setter for the declared locals of the function. The runs are expected in
+/// declaration order, and their starting indices are filled in here.</summary>
+void Function::setLocals(std::vector<localRun> runs)
 {
-	funcOutputs = out;
+	uint32_t first = getSignature().inputs.size();
+	for (auto& run : runs)
+	{
+		run.first = first;
+		first += run.count;
+	}
+	funcLocals = std::move(runs);
 }
 
-/// <summary>Setter that sets the internal title of the function.</summary>
-void Function::setTitle(std::string name)
+///	<summary>Hands the function its expression bytes without decoding them yet.
+///	The hash covers the whole body so callers can tell whether it changed between builds.</summary>
+void Function::setBody(std::vector<byte> in, uint64_t hash)
 {
-	funcName = name;
+	byteCode = std::move(in);
+	bodyHash = hash;
+	decoded = false;
 }
 
-// Not even sure how to approach this lmaoi
 void Function::decodeFunction(std::vector<byte>& in)
+{
+	byteCode = in;
+	decodeFunction();
+}
+
+///	<summary>Decodes the body into statements. A malformed body doesn't throw: whatever
+///	decoded cleanly is kept, followed by an error node where decoding stopped, and the
+///	reason is kept in getError(). Bodies have explicit sizes, so nothing outside this
+///	function is lost.</summary>
+void Function::decodeFunction()
+{
+	loc = 0;
+	memoryUse = memorySummary{};
+	release();
+	decodeError.clear();
+
+	// Every instruction becomes a statement on one stack, in the order it was seen.
+	// Operands are taken from the most recent statements that produce a value.
+	// The stack is scratch space kept per thread, so after the first few functions it
+	// already has the capacity it needs and decoding doesn't have to grow it.
+	thread_local operandStack statementStack;
+	statementStack.clear();
+
+	int failedAt = 0;
+	try
+	{
+		decodeStatements(statementStack, failedAt);
+	}
+	catch (const overBudget& e)
+	{
+		// Nothing of a function that outgrew its arena is kept, so the memory goes back now
+		release();
+		fail(e.what(), failedAt);
+		return;
+	}
+	catch (const std::exception& e)
+	{
+		statementStack.collect(statements);
+		fail(e.what(), failedAt);
+		return;
+	}
+
+	// Whatever is left is the body of the function, in order. The scratch stack keeps its
+	// capacity for the next function, so the body gets its own exactly sized copy.
+	statementStack.collect(statements);
+	decoded = true;
+}
+
+///	<summary>Marks the function as one that couldn't be decoded past 'offset'. An error
+///	node goes after whatever statements it already has.</summary>
+void Function::fail(const std::string& message, int offset)
+{
+	statement* failed = allocateStatement();
+	failed->offset = offset;
+	statements.push_back(failed);
+	decodeError = message;
+	decoded = true;
+}
+
+///	<summary>Lets go of the statements, keeping the body so the function can be decoded
+///	again later. Used to render a module one function at a time.</summary>
+void Function::release()
+{
+	std::vector<statement*>().swap(statements);
+	nodeBlocks.clear();
+	nodesLeft = 0;
+	listBlocks.clear();
+	listsLeft = 0;
+	arenaBytes = 0;
+	memoryUse = memorySummary{};
+	decoded = false;
+}
+
+///	<summary>Caps how many bytes of statements decoding may allocate. A body that needs
+///	more ends up as an error node instead. 0 takes the cap away.</summary>
+void Function::setArenaLimit(size_t bytes)
+{
+	arenaLimit = bytes;
+}
+
+///	<summary>Bytes taken by the statement blocks of the decoded body.</summary>
+size_t Function::getArenaBytes() const
+{
+	return arenaBytes;
+}
+
+// Not even sure how to approach this lmaoi
+void Function::decodeStatements(operandStack& statementStack, int& instrStart)
 {
 	//using namespace opcodes;
 	// Go byte by byte over the byte code.
@@ -41,94 +141,143 @@ void Function::decodeFunction(std::vector<byte>& in)
 	// based decoder, wherein the operations that do not pop the stack
 	// do not build a command.
 	// THIS is the hard part.
-	byteCode = in;
-
-	std::stack<oper> operStack;
-	std::stack<statement*> statementStack;
 	int endsNeeded = 1;
 
 	// Iterate over each byte, determining if it is an operator or an operand
 	while(endsNeeded != 0)
 	{
 		// We are basically changing equations from Reverse Polish Notation into Infix notation for readability.
-		opcodes::ins next = opcodes::find(nextByte());
+		// Prefixed instructions have their real opcode in a LEB after the prefix
+		instrStart = loc;
+		byte code = nextByte();
+		opcodes::ins next = (code == 0xfc || code == 0xfd) ? opcodes::find(code, nextu32()) : opcodes::find(code);
+
+		// Nothing after an unknown instruction can be trusted, since its immediates can't be skipped
+		if (next.op == 0xef)
+			throw std::exception("Unknown instruction");
 		oper temp{ next };// Void for later
 
 		// First, check if the next instruction requires any following bytes
-		if(next.associatedBytes != 0)
+		if(next.associatedBytes != 0 || next.imm != opcodes::immLeb)
 		{
 			// Associate the bytes
-			temp.bytes.resize(next.associatedBytes);
 			getValueBytes(next, temp);
-			//for (int i = 0; i < next.associatedBytes; ++i)
-				//temp.bytes[i] = nextByte();
+		}
+
+		// Loads and stores keep their memarg decoded and get counted
+		const opcodes::memoryAccess access = opcodes::accessOf(next);
+		if (access.width != 0)
+		{
+			int value;
+			int offset = getNextu32(temp.bytes, 0, value);
+			temp.mem.align = value;
+			getNextu32(temp.bytes, offset, value);
+			temp.mem.offset = value;
+			memoryUse.add(access);
 		}
 
 		// Then, check if the operation is a blocking operation that would require more ends
-		if(next.op >= 0x02 && next.op <= 0x03)
+		if(next.op >= 0x02 && next.op <= 0x04)
 		{
 			endsNeeded++;
 
 			// Push a start statement onto the statement stack
-			auto start = new statement;
-			start->operation = next;
+			auto start = allocateStatement();
+			getBlockType(temp);
+			start->operation = std::move(temp);
+			start->offset = instrStart;
+
+			// An if also takes its condition off the stack
+			if (next.op == 0x04)
+				start->leftOperand = statementStack.pop();
+
 			statementStack.push(start);
+			continue;
+		}
 
-			// Eat the block type before continuing
-			nextByte();
+		// An else splits the if it belongs to, but doesn't change how many ends are needed
+		if(next.op == 0x05)
+		{
+			auto split = allocateStatement();
+			split->operation = std::move(temp);
+			split->offset = instrStart;
+
+			// The first branch of an if with a result ends with that result
+			const statement* opener = statementStack.enclosing(0);
+			if (opener != nullptr && getBlockResult(opener->operation) != none)
+				split->leftOperand = statementStack.pop();
+			statementStack.push(split);
 			continue;
 		}
 
-		// To handle external calls, check the function itself to see how many other items need to come off the stack
-		// Do this by setting the temp's bytesComsumed equal to the size of the function inputs
-		//if(next.op == 0x10 || next.op == 0x11)
-		//{
-		//	temp.op.bytesConsumed += funcInputs.size();
-		//}
-		// We can't actually do this right now, so just ignore it.
+		// A branch to a block with a result, or out of a function with one, carries that
+		// result. A br_if that doesn't branch leaves the value where it was, so a statement
+		// of its own stands for the value after it.
+		if(next.op >= 0x0c && next.op <= 0x0e && carriesValue(temp, statementStack))
+		{
+			auto jump = allocateStatement();
+			jump->operation = std::move(temp);
+			jump->offset = instrStart;
+			if (next.op != 0x0c)
+				jump->leftOperand = statementStack.pop();
+			jump->rightOperand = statementStack.pop();
+			statementStack.push(jump);
+
+			if (next.op == 0x0d)
+			{
+				auto kept = allocateStatement();
+				kept->operation.op = opcodes::branchValue;
+				kept->offset = instrStart + 1;
+				kept->producesValue = true;
+				statementStack.push(kept);
+			}
+			continue;
+		}
 
+		// Calls consume as many values as the callee's signature asks for. The signatures
+		// live in the module's shared type table, so look the callee up there.
+		if(next.op == 0x10 || next.op == 0x11)
+		{
+			auto call = allocateStatement();
+			call->operation = std::move(temp);
+			call->offset = instrStart;
+			popArguments(call, callArity(call->operation), statementStack);
+			call->producesValue = callResult(call->operation) != none;
+			statementStack.push(call);
+			continue;
+		}
+
+		// Anything that takes more than two operands keeps them as an argument list
+		if(next.bytesConsumed > 2)
+		{
+			auto many = allocateStatement();
+			many->operation = std::move(temp);
+			many->offset = instrStart;
+			many->producesValue = opcodes::producesValue(next);
+			popArguments(many, next.bytesConsumed, statementStack);
+			statementStack.push(many);
+			continue;
+		}
 
 		// Now, check if the instruction consumes any previous bytes
 		if(next.bytesConsumed != 0)
 		{
 			// Consume them
 			// Create a statement structure to hold the information
-			statement* newStatement = new statement;
-			statement* left = new statement;
-			statement* right = nullptr;
+			statement* newStatement = allocateStatement();
 
 			// Populate the branches
-			// If the operation stack is empty, pull off of the statement stack
-			if(operStack.empty())
-			{
-				left = statementStack.top();
-				statementStack.pop();
-			}
-			else // Not empty, pull off the operation Stack
-			{
-				left->operation = operStack.top();
-				operStack.pop();
-			}
-
+			statement* left = statementStack.pop();
+			statement* right = nullptr;
 			if (next.bytesConsumed > 1)
-			{
-				right = new statement;
-				if(operStack.empty())
-				{
-					right = statementStack.top();
-					statementStack.pop();
-				}
-				else
-				{
-					right->operation = operStack.top();
-					operStack.pop();
-				}
-			}
+				right = statementStack.pop();
 
 			// If there is only one operand, only the left side is populated.
-			newStatement->operation = temp;
+			newStatement->operation = std::move(temp);
+			newStatement->offset = instrStart;
 			newStatement->leftOperand = left;
 			newStatement->rightOperand = right;
+			newStatement->producesValue = opcodes::producesValue(next);
 			statementStack.push(newStatement);
 			continue;
 		}
@@ -139,33 +288,160 @@ void Function::decodeFunction(std::vector<byte>& in)
 		{
 			if((endsNeeded - 1) != 0)
 			{
-				auto end = new statement;
+				auto end = allocateStatement();
 				end->operation = next;
+				end->offset = instrStart;
+
+				// A block with a result ends with it, and leaves it for the instructions after the block
+				const statement* opener = statementStack.enclosing(0);
+				const bool typed = opener != nullptr && getBlockResult(opener->operation) != none;
+				if (typed)
+					end->leftOperand = statementStack.pop();
 				statementStack.push(end);
+
+				if (typed)
+				{
+					auto result = allocateStatement();
+					result->operation.op = opcodes::blockResult;
+					result->offset = opener->offset + 1;
+					result->producesValue = true;
+					statementStack.push(result);
+				}
 			}
 			endsNeeded--;
 			continue;
 		}
 
-		// If the instruction gets here, push it onto the stack
-		operStack.push(temp);
-
+		// If the instruction gets here, it doesn't take anything off the stack
+		auto leaf = allocateStatement();
+		leaf->operation = std::move(temp);
+		leaf->offset = instrStart;
+		leaf->producesValue = opcodes::producesValue(next);
+		statementStack.push(leaf);
 	}
-
-	// Now, we have to unwind the stack(s) to establish what our functions actually are.
-	ops = operStack;
-	statements = statementStack;
 }
 
 /// <summary>Getter function that returns the title</summary>
-std::string Function::getTitle()
+std::string_view Function::getTitle() const
 {
 	return funcName;
 }
 
 int Function::getInputSize() const
 {
-	return funcInputs.size();
+	return getSignature().inputs.size();
+}
+
+/// <summary>Getter for the canonical type index. Two functions have the same
+/// signature exactly when these are equal.</summary>
+uint32_t Function::getTypeIndex() const
+{
+	return typeIdx;
+}
+
+/// <summary>The signature of the function, looked up in the shared type table.
+/// A function that was never given one has no inputs and no output.</summary>
+const signature& Function::getSignature() const
+{
+	static const signature unknown{ {}, dataDef{ none } };
+	const signature* sig = types != nullptr ? types->signatureAt(typeIdx) : nullptr;
+	if (sig == nullptr)
+		return unknown;
+
+	return *sig;
+}
+
+/// <summary>Getter for the run-length locals declaration.</summary>
+const std::vector<localRun>& Function::getLocals() const
+{
+	return funcLocals;
+}
+
+/// <summary>Getter for the load and store counts found while decoding.</summary>
+const memorySummary& Function::getMemorySummary() const
+{
+	return memoryUse;
+}
+
+/// <summary>Counts one load or store in the bucket for its width.</summary>
+void memorySummary::add(const opcodes::memoryAccess& access)
+{
+	int bucket = 0;
+	while (bucket < buckets - 1 && (1 << bucket) < access.width)
+		bucket++;
+
+	if (access.store)
+		stores[bucket]++;
+	else
+		loads[bucket]++;
+}
+
+uint32_t memorySummary::totalLoads() const
+{
+	uint32_t total = 0;
+	for (auto count : loads)
+		total += count;
+	return total;
+}
+
+uint32_t memorySummary::totalStores() const
+{
+	uint32_t total = 0;
+	for (auto count : stores)
+		total += count;
+	return total;
+}
+
+/// <summary>Number of declared locals, not counting the parameters.</summary>
+uint32_t Function::getLocalCount() const
+{
+	if (funcLocals.empty())
+		return 0;
+
+	return funcLocals.back().first + funcLocals.back().count - getSignature().inputs.size();
+}
+
+/// <summary>Returns the type of a local index, which covers the parameters first
+/// and the declared locals after them. Unknown indices give 'none'.</summary>
+dataTypes Function::getLocalType(uint32_t idx) const
+{
+	const auto& inputs = getSignature().inputs;
+	if (idx < inputs.size())
+		return inputs[idx].type;
+
+	// Find the last run starting at or before the index
+	auto run = std::upper_bound(funcLocals.begin(), funcLocals.end(), idx,
+		[](uint32_t value, const localRun& r) { return value < r.first; });
+	if (run == funcLocals.begin())
+		return none;
+
+	--run;
+	if (idx - run->first >= run->count)
+		return none;
+
+	return run->type;
+}
+
+uint64_t Function::getBodyHash() const
+{
+	return bodyHash;
+}
+
+bool Function::isDecoded() const
+{
+	return decoded;
+}
+
+/// <summary>The expression bytes of the body, without the locals declaration.</summary>
+const std::vector<byte>& Function::getBody() const
+{
+	return byteCode;
+}
+
+/// <summary>Why the body couldn't be decoded, or an empty string if it could.</summary>
+const std::string& Function::getError() const
+{
+	return decodeError;
 }
 
 /// <summary>This function emits the next byte in the byte stream sequence
@@ -181,63 +457,346 @@ byte Function::nextByte()
 	return toRet;
 }
 
+/// <summary>Reads a LEB encoded u32 from the byte stream.</summary>
+uint32_t Function::nextu32()
+{
+	uint32_t result = 0;
+	int shift = 0;
+	byte next;
+	do
+	{
+		next = nextByte();
+		result |= (uint32_t)(next & 0x7f) << shift;
+		shift += 7;
+	} while (next > 0x7f && shift < 35);
+
+	return result;
+}
+
 /// <summary>This function will determine from hints given by the instruction 
 /// and the bytes how many bytes to associate with the operation. This is 
 /// required to to cover the bases of signed/unsigned encoded values
-/// and floating points.</summary>
+/// and floating points. The immediates sit together in the body, so they are
+/// stepped over and then handed to the operation in one piece.</summary>
 void Function::getValueBytes(const opcodes::ins& ins, oper& oper)
 {
-	std::vector<byte> temp;
-	int maxLength = 1;
+	const int start = loc;
 
-	if (ins.op == 0x41 || ins.op == 0x43)
-		maxLength = 4;
-	else if (ins.op == 0x42 || ins.op == 0x44)
-		maxLength = 8;
-
-	if (ins.op == 0x41 || ins.op == 0x42) // Integers can be any length up to the max
+	if (ins.imm == opcodes::immV128) // Constants and shuffle masks are 16 raw bytes
 	{
-		for (int k = 0; k < ins.associatedBytes; ++k)
+		for (int i = 0; i < 16; ++i)
+			nextByte();
+	}
+	else if (ins.imm == opcodes::immLane) // Lane indices are a single raw byte
+	{
+		nextByte();
+	}
+	else if (ins.op == 0x43 || ins.op == 0x44) // Floats are always the byte size
+	{
+		int length = ins.op == 0x43 ? 4 : 8;
+		for (int i = 0; i < length; ++i)
+			nextByte();
+	}
+	else if (ins.associatedBytes == 0xff) // A vector: the LEB length, then that many LEB entries
+	{
+		int length = 0;
+		int shift = 0;
+		byte next;
+		do
 		{
-			byte next = nextByte();
+			next = nextByte();
+			length |= (next & 0x7f) << shift;
+			shift += 7;
+		} while (next > 0x7f && shift < 35);
 
-			for (int i = 0; i < maxLength; ++i)
+		// br_table has the default label after the vector
+		int entries = length + (ins.op == 0x0e ? 1 : 0);
+
+		// Every entry takes at least a byte, so anything longer than the rest of the body is bogus.
+		if (length < 0 || entries > (int)(byteCode.size() - loc))
+			throw std::exception("Vector immediate runs past the end of the function");
+
+		for (int k = 0; k < entries; ++k)
+		{
+			for (int i = 0; i < 5; ++i)
 			{
-				if (next <= 0x7f) // && (ins.op != 0x42 && ins.op != 0x44)))
-				{
-					// break out
-					temp.push_back(next);
+				if (nextByte() <= 0x7f)
 					break;
-				}
-				temp.push_back(next);
-				next = nextByte();
 			}
 		}
 	}
-	else // Floats are always (?) the byte size
+	else // Everything else is a list of LEB numbers, which can be any length up to the max
 	{
-		for(int k = 0; k < ins.associatedBytes; ++k)
+		// An i64 can take up to 10 bytes, everything else fits in 5.
+		int maxLength = ins.op == 0x42 ? 10 : 5;
+		for (int k = 0; k < ins.associatedBytes; ++k)
 		{
-			//byte next = nextByte();
-
-			for(int i = 0; i < maxLength; ++i)
+			for (int i = 0; i < maxLength; ++i)
 			{
-				byte next = nextByte();
-				temp.push_back(next);
+				if (nextByte() <= 0x7f)
+					break;
 			}
 		}
+
+		// Lane loads and stores have the lane after the memarg
+		if (ins.imm == opcodes::immMemargLane)
+			nextByte();
+	}
+
+	oper.bytes.assign(byteCode.data() + start, loc - start);
+}
+
+/// <summary>Reads the block type that follows a block, loop or if. It is either
+/// 0x40 for nothing, a single value type, or a signed LEB index into the
+/// type section for blocks with several inputs or results.</summary>
+void Function::getBlockType(oper& oper)
+{
+	const int start = loc;
+	byte next = nextByte();
+
+	// 0x40 and the value types all fit in a single byte. Otherwise it's an
+	// s33 type index, which is at most 5 bytes
+	if (next != 0x40 && (next < 0x6f || next > 0x7f))
+	{
+		for (int i = 1; i < 5 && next > 0x7f; ++i)
+			next = nextByte();
+	}
+
+	oper.bytes.assign(byteCode.data() + start, loc - start);
+}
+
+/// <summary>Hands out a statement owned by the function. Statements are made in blocks
+/// that double in size, so a body of n instructions costs a handful of allocations
+/// rather than n, and they all go away with the function. The first block is always
+/// handed out, so there is room for an error node whatever the limit.</summary>
+statement* Function::allocateStatement()
+{
+	if (nodesLeft == 0)
+	{
+		blockCapacity = nodeBlocks.empty() ? 32 : std::min<size_t>(blockCapacity * 2, 4096);
+		const size_t blockBytes = blockCapacity * sizeof(statement);
+		if (arenaLimit != 0 && !nodeBlocks.empty() && arenaBytes + blockBytes > arenaLimit)
+			throw overBudget("Function needs more memory than the budget allows");
+
+		arenaBytes += blockBytes;
+		nodeBlocks.push_back(std::make_unique<statement[]>(blockCapacity));
+		nodesLeft = blockCapacity;
+	}
+
+	return &nodeBlocks.back()[blockCapacity - nodesLeft--];
+}
+
+/// <summary>Hands out room for an argument list of 'count' statements, from blocks made
+/// the same way as the statements. A list longer than a block gets a block of its own.</summary>
+statement** Function::allocateList(size_t count)
+{
+	if (count > listsLeft)
+	{
+		listCapacity = listBlocks.empty() ? 64 : std::min<size_t>(listCapacity * 2, 4096);
+		const size_t entries = std::max(count, listCapacity);
+		const size_t blockBytes = entries * sizeof(statement*);
+		if (arenaLimit != 0 && arenaBytes + blockBytes > arenaLimit)
+			throw overBudget("Function needs more memory than the budget allows");
+
+		arenaBytes += blockBytes;
+		listBlocks.push_back(std::make_unique<statement*[]>(entries));
+		listsLeft = entries;
+		listCapacity = entries;
+	}
+
+	statement** list = &listBlocks.back()[listCapacity - listsLeft];
+	listsLeft -= count;
+	return list;
+}
+
+void operandStack::clear()
+{
+	order.clear();
+	values.clear();
+	blocks.assign(1, scope{});
+}
+
+///	<summary>Adds a statement after the others. Block starts close off the values before
+///	them until their end. An else starts its branch over, and an end gives the values
+///	before the block back. Values left over in a branch can't be taken outside it.</summary>
+void operandStack::push(statement* node)
+{
+	const byte op = node->operation.op.op;
+	if (op == 0x05 || op == 0x0b)
+	{
+		while (!values.empty() && values.back() >= blocks.back().start)
+			values.pop_back();
+	}
+
+	if (op >= 0x02 && op <= 0x04)
+		blocks.push_back(scope{ order.size() + 1, node });
+	else if (op == 0x05)
+		blocks.back().start = order.size() + 1;
+	else if (op == 0x0b)
+	{
+		if (blocks.size() > 1)
+			blocks.pop_back();
+	}
+	else if (node->producesValue)
+		values.push_back((uint32_t)order.size());
+	order.push_back(node);
+}
+
+/// <summary>Pulls the next operand for an instruction: the most recent statement
+/// that produces a value. Values can sit under statements that don't produce
+/// anything, but are never taken from outside the block being decoded.
+/// Returns nullptr if there is nothing to take.</summary>
+statement* operandStack::pop()
+{
+	if (values.empty() || values.back() < blocks.back().start)
+		return nullptr;
+
+	statement*& slot = order[values.back()];
+	values.pop_back();
+	statement* taken = slot;
+	slot = nullptr;
+	return taken;
+}
+
+///	<summary>The block, loop or if a branch label refers to: 0 is the innermost open one.
+///	Gives nullptr when the label refers to the function body itself.</summary>
+statement* operandStack::enclosing(uint32_t label) const
+{
+	if (label + 1 >= blocks.size())
+		return nullptr;
+
+	return blocks[blocks.size() - 1 - label].opener;
+}
+
+///	<summary>Copies the statements nothing took as an operand into 'out', in order.</summary>
+void operandStack::collect(std::vector<statement*>& out) const
+{
+	size_t kept = 0;
+	for (statement* node : order)
+		kept += node != nullptr ? 1 : 0;
+	out.reserve(kept);
+	for (statement* node : order)
+	{
+		if (node != nullptr)
+			out.push_back(node);
+	}
+}
+
+/// <summary>Pops 'count' operands into the argument list of a statement, keeping
+/// them in the order they were pushed.</summary>
+void Function::popArguments(statement* target, int count, operandStack& statementStack)
+{
+	// Gathered in scratch space first, since how many there really are isn't known up front
+	thread_local std::vector<statement*> popped;
+	popped.clear();
+	for (int i = 0; i < count; ++i)
+	{
+		statement* argument = statementStack.pop();
+		if (argument == nullptr)
+			break;
+		popped.push_back(argument);
+	}
+	if (popped.empty())
+		return;
+
+	// The arguments came off the stack last to first.
+	target->arguments.items = allocateList(popped.size());
+	target->arguments.count = (uint32_t)popped.size();
+	std::reverse_copy(popped.begin(), popped.end(), target->arguments.items);
+}
+
+/// <summary>Looks up what a call leaves on the stack, using the same lookup as callArity.</summary>
+dataTypes Function::callResult(const oper& call) const
+{
+	if (types == nullptr || call.bytes.empty())
+		return none;
+
+	int idx;
+	getNextu32(call.bytes, 0, idx);
+
+	const signature* sig = call.op.op == 0x10 ? types->funcSignature(idx) : types->typeAt(idx);
+	if (sig == nullptr)
+		return none;
+
+	return sig->output.type;
+}
+
+/// <summary>Looks up how many values a call takes off the stack. A direct call
+/// carries the function index, an indirect call carries the type index and
+/// additionally pops the table slot to call through.</summary>
+int Function::callArity(const oper& call) const
+{
+	const int extra = call.op.op == 0x11 ? 1 : 0;
+	if (types == nullptr || call.bytes.empty())
+		return extra;
+
+	int idx;
+	getNextu32(call.bytes, 0, idx);
+
+	const signature* sig = call.op.op == 0x10 ? types->funcSignature(idx) : types->typeAt(idx);
+	if (sig == nullptr)
+		return extra;
+
+	return (int)sig->inputs.size() + extra;
+}
+
+/// <summary>The type of the value a block, loop or if leaves when it ends, or none. Blocks
+/// typed by an index into the type section leave the result of that signature.</summary>
+dataTypes Function::getBlockResult(const oper& block) const
+{
+	const immediateBytes& bytes = block.bytes;
+	if (bytes.empty() || bytes[0] == 0x40)
+		return none;
+	if (bytes[0] >= 0x6f && bytes[0] <= 0x7f)
+		return valueType(bytes[0]);
+
+	int idx;
+	getNextu32(bytes, 0, idx);
+	const signature* sig = types != nullptr ? types->typeAt(idx) : nullptr;
+	return sig != nullptr ? sig->output.type : none;
+}
+
+/// <summary>Whether a br, br_if or br_table carries a value: every label it can go to is
+/// a block with a result, or the function body of a function with one. Branching to a
+/// loop starts it over, which takes nothing.</summary>
+bool Function::carriesValue(const oper& branch, const operandStack& statementStack) const
+{
+	if (branch.bytes.empty())
+		return false;
+
+	int offset = 0;
+	int count = 1;
+	if (branch.op.op == 0x0e)
+	{
+		offset += getNextu32(branch.bytes, 0, count);
+		count++;
+	}
+
+	for (int i = 0; i < count && offset < (int)branch.bytes.size(); ++i)
+	{
+		int label;
+		offset += getNextu32(branch.bytes, offset, label);
+		const statement* target = statementStack.enclosing((uint32_t)label);
+		if (target == nullptr ? getSignature().output.type == none
+			: target->operation.op.op == 0x03 || getBlockResult(target->operation) == none)
+			return false;
 	}
-	oper.bytes = temp;
+	return true;
 }
 
 /// <summary>Given a statement, print out the commands that take place.</summary>
-std::string printStatement(statement* top)
+std::string printStatement(const statement* top)
 {
+	static thread_local int depth = 0;
+	const depthGuard guard(depth);
+	if (guard.tooDeep())
+		return "...";
+
 	std::string output;
 	std::string leftOut;
 	std::string rightOut;
-	statement* left = top->leftOperand;
-	statement* right = top->rightOperand;
+	const statement* left = top->leftOperand;
+	const statement* right = top->rightOperand;
 
 	// Drill down
 	if(left != nullptr)
@@ -252,6 +811,38 @@ std::string printStatement(statement* top)
 		rightOut = '(' + rightOut + ')';
 	}
 
+	// Values the decoder stands in for are named after the instruction they come from,
+	// which starts right before them
+	if (opcodes::isStandIn(top->operation.op))
+		return std::string(top->operation.op.symbol) + ' ' + std::to_string(top->offset - 1);
+
+	// Loads and stores read like pointer dereferences: *(i32*)(base + offset)
+	const opcodes::memoryAccess access = opcodes::accessOf(top->operation.op);
+	if (access.pointee != nullptr)
+	{
+		// A store has its value on top of the address
+		const statement* address = access.store ? right : left;
+		std::string pointer = std::string("*(") + access.pointee + "*)(";
+		if (address != nullptr && address->operation.op.op == 0x41)
+		{
+			// A constant address is a plain number, with the offset already added in
+			int64_t base;
+			getNexts64(address->operation.bytes, 0, base);
+			pointer += std::to_string((uint64_t)(uint32_t)base + top->operation.mem.offset);
+		}
+		else
+		{
+			pointer += address != nullptr ? printStatement(address) : "?";
+			if (top->operation.mem.offset != 0)
+				pointer += " + " + std::to_string(top->operation.mem.offset);
+		}
+		pointer += ')';
+
+		if (!access.store)
+			return pointer;
+		return pointer + " = " + (left != nullptr ? printStatement(left) : "?");
+	}
+
 	// If at the bottom
 	output = top->operation.op.symbol;
 	if(top->operation.op.op >= 0x41 && top->operation.op.op <= 0x44)
@@ -259,47 +850,110 @@ std::string printStatement(statement* top)
 		// Decode the constant into it's value
 		auto op = top->operation.op.op;
 		std::stringstream ss;
-		if(op == 0x41 || op == 0x43) // 4 bytes max each
+		if (op == 0x41 || op == 0x42) // Integers are signed LEBs
 		{
-			char list[4] = { 0x80, 0x80, 0x80, 0x80 };
+			int64_t value;
+			getNexts64(top->operation.bytes, 0, value);
+			if (op == 0x41)
+				ss << ' ' << (int32_t)value;
+			else
+				ss << ' ' << value;
+		}
+		else if(op == 0x43) // 4 bytes max each
+		{
+			char list[4] = { 0, 0, 0, 0 };
 			int i = 0;
 			for (auto o : top->operation.bytes)
 			{
+				if (i == 4)
+					break;
 				list[i] = o;
 				++i;
 			}
-			if (op == 0x41) //integer
-				ss << ' ' << u_decLEB32(list);
-			else
-				ss << ' ' << decodeFloat(list);
-
-			output += ss.str();
+			ss << ' ' << decodeFloat(list);
 		}
 		else // 8 bytes max each
 		{
-			char list[8] = { 0x80, 0x80, 0x80, 0x80,
-							 0x80, 0x80, 0x80, 0x80};
+			char list[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
 			int i = 0;
 			for (auto o : top->operation.bytes)
 			{
+				if (i == 8)
+					break;
 				list[i] = o;
 				++i;
 			}
-			if (op == 0x42) //integer
-				ss << ' ' << u_decLEB32(list);
-			else
-				ss << ' ' << decodeDouble(list);
-			output += ss.str();
+			ss << ' ' << decodeDouble(list);
+		}
+		output += ss.str();
+	}
+	else if (top->operation.op.imm == opcodes::immV128)
+	{
+		// A constant is shown as four i32 lanes, a shuffle as its 16 lane indices
+		const auto& bytes = top->operation.bytes;
+		std::stringstream ss;
+		if (top->operation.op.subOp == 0x0c)
+		{
+			ss << " i32x4" << std::hex;
+			for (int lane = 0; lane + 3 < (int)bytes.size(); lane += 4)
+			{
+				uint32_t value = bytes[lane] | (bytes[lane + 1] << 8) | (bytes[lane + 2] << 16) | ((uint32_t)bytes[lane + 3] << 24);
+				ss << " 0x" << std::setw(8) << std::setfill('0') << value;
+			}
+		}
+		else
+		{
+			for (auto lane : bytes)
+				ss << ' ' << (int)lane;
 		}
+		output += ss.str();
+	}
+	else if (top->operation.op.op >= 0x02 && top->operation.op.op <= 0x04)
+	{
+		// Blocks show their type, if they have one
+		std::string type = blockTypeName(top->operation.bytes);
+		if (!type.empty())
+			output += ' ' + type;
 	}
 	else
 	{
-		for (auto byte : top->operation.bytes)
+		// Every other immediate is a list of LEB numbers
+		const auto& bytes = top->operation.bytes;
+		int offset = 0;
+
+		// Vectors don't need their length shown
+		if (top->operation.op.associatedBytes == 0xff && !bytes.empty())
+		{
+			int length;
+			offset += getNextu32(bytes, 0, length);
+		}
+
+		// Typed selects list value types rather than numbers
+		if (top->operation.op.op == 0x1c)
+		{
+			for (; offset < (int)bytes.size(); ++offset)
+				output += std::string(" ") + typeName(valueType(bytes[offset]));
+		}
+
+		for (; offset < (int)bytes.size();)
+		{
+			int value;
+			offset += getNextu32(bytes, offset, value);
+			output += ' ' + std::to_string(value);
+		}
+	}
+
+	// Calls list their arguments
+	if (!top->arguments.empty())
+	{
+		output += " (";
+		for (size_t i = 0; i < top->arguments.size(); ++i)
 		{
-			std::stringstream ss;
-			ss << (int)byte;
-			output += ' ' + ss.str();
+			if (i != 0)
+				output += ", ";
+			output += printStatement(top->arguments[i]);
 		}
+		return output + ')';
 	}
 
 	if (left == nullptr && right == nullptr)
@@ -309,102 +963,36 @@ std::string printStatement(statement* top)
 	return rightOut + ' ' + output + ' ' + leftOut; // Backwards because Reverse Polish Notation (aka I'm dumb)
 }
 
-std::ostream& operator<<(std::ostream& out, const Function& c)
-{	
-	// The statement stack is actually backwards from what we want to print
-	// to the ostream. Start by reversing it
-	std::stack<statement*> toReverse = c.statements; // NOTE: Make sure this copies rather than references.
-	std::stack<statement*> output;
-	while(!toReverse.empty())
-	{
-		output.push(toReverse.top());
-		toReverse.pop();
-	}
+/// <summary>Gives the readable form of a block type: nothing for an empty
+/// block, the value type for a single result, or the type index.</summary>
+std::string blockTypeName(const immediateBytes& bytes)
+{
+	if (bytes.empty() || bytes[0] == 0x40)
+		return "";
 
-	// Now that the stack has been reversed, we can do some formatting!
-	// Start with the function signature
-	if (c.funcOutputs.type == i32)
-		out << "i32 ";
-	else if (c.funcOutputs.type == i64)
-		out << "i64 ";
-	else if (c.funcOutputs.type == f32)
-		out << "f32 ";
-	else if (c.funcOutputs.type == f64)
-		out << "f64 ";
-	else if (c.funcOutputs.type == none)
-		out << "void ";
-
-	// Add the function name
-	out << c.funcName << "(";
-
-	std::string inputs;
-	// Add the input definitions
-	for (const auto& func_input : c.funcInputs)
+	switch (bytes[0])
 	{
-		if (func_input.type == i32)
-			inputs += "i32 " + func_input.name + ", ";
-		else if (func_input.type == i64)
-			inputs += "i64 " + func_input.name + ", ";
-		else if (func_input.type == f32)
-			inputs += "f32 " + func_input.name + ", ";
-		else if (func_input.type == f64)
-			inputs += "f64 " + func_input.name + ", ";
-		else if (func_input.type == none)
-			inputs += "void " + func_input.name + ", ";
+	case 0x7f: return "i32";
+	case 0x7e: return "i64";
+	case 0x7d: return "f32";
+	case 0x7c: return "f64";
+	case 0x7b: return "v128";
+	case 0x70: return "funcref";
+	case 0x6f: return "externref";
+	default: break;
 	}
-	// Remove the trailing comma and space
-	inputs = inputs.substr(0, inputs.size() - 2);
-	out << inputs;
-	out << ')' << std::endl;
 
+	int typeIdx;
+	getNextu32(bytes, 0, typeIdx);
+	return "type " + std::to_string(typeIdx);
+}
 
-	// Now we have to print from our reversed stack thing for each statement.
-	int tabs = 1;
-	while(!output.empty())
-	{
-		std::string written = printStatement(output.top());
-		output.pop();
-
-		if (written == "end")
-			tabs--;
-
-		out << tabMaker(tabs) << written << std::endl;
-
-		// Figure out the number of tabs to place before the item
-		if (written == "block"
-			|| written == "loop"
-			|| written.find("if") != std::string::npos)
-		{
-			// Check for a br_if, which does not constitute a tab
-			if (written.substr(0, 5) != "br_if")
-				tabs++;
-		}
-
-	}
-
-	// If there is anything on the operation stack, print it now
-	statement temp;
-	if (!c.ops.empty())
-	{
-		temp.operation = c.ops.top();
-		out << tabMaker(1) << printStatement(&temp);
-	}
-	//for(int i = 0; i < c.ops.size(); ++i)
-	//{
-	//	out << tabMaker(1) << c.ops.top().op.symbol;
-	//	for (byte elm: c.ops.top().bytes)
-	//	{
-	//		std::stringstream ss;
-	//		ss << (int)elm;
-	//		out << ' ' + ss.str();
-	//	}
-	//}
-
-	// Put the final end in the function
-	out << std::endl << tabMaker(0) << "end" << std::endl;
-
-
-	return out;
+/// <summary>Prints the function in the default format. See PseudoEmitter.</summary>
+std::ostream& operator<<(std::ostream& out, const Function& c)
+{
+	std::string text;
+	PseudoEmitter().emit(c, -1, text);
+	return out << text;
 }
 
 std::string tabMaker(int size)
@@ -1,37 +1,60 @@
 #ifndef FUNCTION_H
 #define FUNCTION_H
+#include <algorithm>
+#include <exception>
+#include <memory>
 #include <string>
 #include <sstream>
 #include <vector>
-#include <stack>
 #include "Sectioner.h"
 #include "opcodes.h"
+#include "TypeTable.h"
 
-///	<summary>Defines the data types that WASM works with.
-///	'none' is used in place of void, but they are equivalent
-///	</summary>
-enum dataTypes
+///	<summary>The immediate of a load or store: the alignment hint (as a power of two)
+///	and the constant offset added to the address.</summary>
+struct memarg
 {
-	i32, // The iN values are interpreted as u32 until any operation occurs to convert them.
-	i64,
-	f32,
-	f64,
-
-	none // Placeholder for void
+	uint32_t align = 0;
+	uint32_t offset = 0;
 };
 
-///	<summary>Simple struct to define what a full data definition looks like.</summary>
-struct dataDef
+///	<summary>The immediate bytes of an instruction. Nearly every immediate fits in the
+///	statement itself; the few that don't (br_table and typed select lists) point into the
+///	body they were read from, which the function keeps for as long as its statements.
+///	Either way decoding an instruction doesn't allocate anything for its immediates.</summary>
+class immediateBytes
 {
-	dataTypes type{};
-	bool pointer = false;
-	std::string name{};
+public:
+	static const uint32_t inlineSize = 16;
+
+	///	<summary>Takes 'count' bytes. Short runs are copied; longer ones have to outlive this.</summary>
+	void assign(const byte* from, size_t count)
+	{
+		length = (uint32_t)count;
+		external = count > inlineSize ? from : nullptr;
+		if (external == nullptr)
+			std::copy(from, from + count, local);
+	}
+
+	const byte* data() const { return external != nullptr ? external : local; }
+	size_t size() const { return length; }
+	bool empty() const { return length == 0; }
+	const byte* begin() const { return data(); }
+	const byte* end() const { return data() + length; }
+	byte operator[](size_t i) const { return data()[i]; }
+	byte back() const { return data()[length - 1]; }
+
+private:
+	byte local[inlineSize]{};
+	const byte* external = nullptr;
+	uint32_t length = 0;
 };
 
 struct oper
 {
 	opcodes::ins op{ 0xef, "error" };
-	std::vector<byte> bytes{};
+	immediateBytes bytes{};
+	memarg mem{}; // Only filled in for loads and stores
 
 	oper() = default;
 
@@ -39,12 +62,22 @@ struct oper
 	{
 		op = operation;
 	}
+};
 
-	oper(opcodes::ins& operation, std::vector<byte>& in)
-	{
-		op = operation;
-		bytes = in;
-	}
+struct statement;
+
+///	<summary>The operands of an instruction taking more than two of them, in stack order.
+///	The list itself lives in the function's arena.</summary>
+struct statementList
+{
+	statement** items = nullptr;
+	uint32_t count = 0;
+
+	statement** begin() const { return items; }
+	statement** end() const { return items + count; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	statement* operator[](size_t i) const { return items[i]; }
 };
 
 struct statement
@@ -52,9 +85,87 @@ struct statement
 	oper operation{};
 	statement* leftOperand  = nullptr;
 	statement* rightOperand = nullptr;
+	statementList arguments{}; // Used by calls and anything else taking more than two operands, in stack order.
+	bool producesValue = false; // Whether later instructions can take this as an operand
+	int offset = 0; // Where the instruction starts in the function's byte code
 };
 
-std::string printStatement(statement* top);
+///	<summary>One entry of a function's locals declaration: 'count' locals in a row
+///	that all share 'type'. Some functions declare tens of thousands of locals,
+///	so they are kept as runs rather than one entry per local.</summary>
+struct localRun
+{
+	uint32_t count = 0;
+	dataTypes type = none;
+	uint32_t first = 0; // Local index of the first local in the run. Parameters come before it.
+};
+
+///	<summary>Counts of the loads and stores in a function, bucketed by how wide the
+///	access is: 1, 2, 4, 8 and 16 bytes.</summary>
+struct memorySummary
+{
+	static const int buckets = 5;
+	uint32_t loads[buckets]{};
+	uint32_t stores[buckets]{};
+
+	void add(const opcodes::memoryAccess& access);
+	uint32_t totalLoads() const;
+	uint32_t totalStores() const;
+};
+
+///	<summary>Expressions are rendered by recursing into their operands. Locals folded
+///	into each other by the simplifier can make a chain thousands of levels deep, so
+///	renderers count how deep they are and cut the expression short past 'limit'
+///	rather than run out of stack.</summary>
+struct depthGuard
+{
+	static const int limit = 256;
+
+	explicit depthGuard(int& depth) : depth(depth) { ++depth; }
+	~depthGuard() { --depth; }
+	bool tooDeep() const { return depth > limit; }
+
+	int& depth;
+};
+
+///	<summary>Thrown when a body needs more statements than its arena is allowed to hold.</summary>
+class overBudget : public std::exception
+{
+public:
+	explicit overBudget(const char* message) : std::exception(message) {}
+};
+
+///	<summary>The statements of a body while it is decoded, in the order they were seen.
+///	An operand is the most recent statement that produces a value and hasn't been
+///	taken yet, and never comes from outside the block being decoded. The values still
+///	on offer are kept on a stack of their own, so taking one doesn't have to walk back
+///	over the statements that produce nothing. A taken statement leaves a hole, and
+///	the holes are dropped once when the body is done.<br>
+///	Where each open block's values start is kept on a stack too, so once a block ends
+///	the values pushed before it can be taken again.</summary>
+struct operandStack
+{
+	///	<summary>An open block: where its values start, and the block, loop or if that
+	///	opened it. The body of the function has no opener.</summary>
+	struct scope
+	{
+		size_t start = 0;
+		statement* opener = nullptr;
+	};
+
+	void clear();
+	void push(statement* node);
+	statement* pop();
+	statement* enclosing(uint32_t label) const;
+	void collect(std::vector<statement*>& out) const;
+
+	std::vector<statement*> order{}; // nullptr where a statement was taken as an operand
+	std::vector<uint32_t> values{}; // Positions in 'order' of the values not taken yet
+	std::vector<scope> blocks{}; // Innermost last. The body of the function is the first.
+};
+
+std::string printStatement(const statement* top);
+std::string blockTypeName(const immediateBytes& bytes);
 std::string tabMaker(int size);
 
 ///	<summary>
@@ -66,30 +177,68 @@ class Function
 {
 public:
 	Function();
-	Function(std::vector<dataDef> funcIns, dataDef& funcOuts);
-	void setInputs(std::vector<dataDef> ins); // TODO: Watch this to make sure it stays in line.
-	void setOutput(dataDef& out);
-	void setTitle(std::string name);
+	Function(const TypeTable* table, uint32_t typeIdx);
+	void setTitle(std::string_view name);
+	void setLocals(std::vector<localRun> runs);
+	void setBody(std::vector<byte> in, uint64_t hash);
+	void decodeFunction();
 	void decodeFunction(std::vector<byte>& in);
+	void fail(const std::string& message, int offset);
+	void release();
+	void setArenaLimit(size_t bytes);
+	size_t getArenaBytes() const;
 
 	friend std::ostream& operator<<(std::ostream& out, const Function& c); // Print function to see the current results.
-	std::string getTitle();
+	std::string_view getTitle() const;
 	int getInputSize() const;
+	uint32_t getTypeIndex() const;
+	const signature& getSignature() const;
 	int getOtherInputSize(int funcIdx);
-
-	std::stack<statement*> statements;
+	const std::vector<localRun>& getLocals() const;
+	const memorySummary& getMemorySummary() const;
+	uint32_t getLocalCount() const;
+	dataTypes getLocalType(uint32_t idx) const;
+	dataTypes getBlockResult(const oper& block) const;
+	uint64_t getBodyHash() const;
+	bool isDecoded() const;
+	const std::string& getError() const;
+	const std::vector<byte>& getBody() const;
+
+	std::vector<statement*> statements;
 	bool isImported = false;
 
 private:
 	byte nextByte();
+	uint32_t nextu32();
+	statement* allocateStatement();
+	statement** allocateList(size_t count);
+	void decodeStatements(operandStack& statementStack, int& instrStart);
 	void getValueBytes(const opcodes::ins& ins, oper& oper);
-
-	std::string funcName{};
-	std::vector<dataDef> funcInputs{};
-	dataDef funcOutputs{};
-	std::stack<oper> ops;
+	void getBlockType(oper& oper);
+	void popArguments(statement* target, int count, operandStack& statementStack);
+	int callArity(const oper& call) const;
+	dataTypes callResult(const oper& call) const;
+	bool carriesValue(const oper& branch, const operandStack& statementStack) const;
+
+	std::string_view funcName{}; // Interned in the module's StringTable
+	uint32_t typeIdx = TypeTable::noType; // Canonical index into the shared type table
+	std::vector<localRun> funcLocals{};
+	memorySummary memoryUse{};
+	const TypeTable* types = nullptr; // Shared with every other function of the module. Never written to.
+
+	std::vector<std::unique_ptr<statement[]>> nodeBlocks{}; // Owns every statement in 'statements'
+	size_t blockCapacity = 0;
+	size_t nodesLeft = 0; // Unused statements at the end of the last block
+	std::vector<std::unique_ptr<statement*[]>> listBlocks{}; // Owns every argument list
+	size_t listCapacity = 0;
+	size_t listsLeft = 0; // Unused entries at the end of the last list block
+	size_t arenaBytes = 0; // What the blocks take together
+	size_t arenaLimit = 0; // Most the blocks may take, or 0 for no limit
 
 	std::vector<byte> byteCode{};
+	uint64_t bodyHash = 0; // Hash of the raw body, locals included
+	bool decoded = false;
+	std::string decodeError{}; // Empty unless the body was malformed
 	int loc = 0;
 };
 
@@ -0,0 +1,145 @@
+#include "FuzzHarness.h"
+#include "Module.h"
+#include "Profiler.h"
+#include "PseudoEmitter.h"
+#include "CEmitter.h"
+#include "WatEmitter.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+///	<summary>Decompiles a module from memory with every backend and throws the output away.
+///	Gives false, with the reason, when the module is rejected.</summary>
+bool FuzzHarness::run(const byte* data, size_t size, std::string& error)
+{
+	try
+	{
+		Module module(data, size);
+		std::ostream nowhere(nullptr);
+
+		PseudoEmitter pseudo;
+		CEmitter c;
+		WatEmitter wat;
+		for (Emitter* emitter : { (Emitter*)&pseudo, (Emitter*)&c, (Emitter*)&wat })
+		{
+			module.prepare(*emitter);
+			module.renderAll(*emitter, nowhere);
+		}
+
+		Profiler::profile(module.getMediator());
+
+		// A spread of offsets across the whole module, inside bodies and out
+		std::vector<uint32_t> offsets;
+		const size_t step = std::max<size_t>(1, size / 64);
+		for (size_t offset = 0; offset < size; offset += step)
+			offsets.push_back((uint32_t)offset);
+		module.symbolize(offsets);
+		return true;
+	}
+	catch (const std::exception& e)
+	{
+		error = e.what();
+		return false;
+	}
+}
+
+///	<summary>Runs every file under 'directory' and writes a report. 'listed' is how many
+///	of the slowest and hungriest inputs are named.</summary>
+void FuzzHarness::runCorpus(const std::string& directory, std::ostream& out, size_t listed)
+{
+	struct outcome
+	{
+		std::string path;
+		size_t bytes = 0;
+		double seconds = 0;
+		size_t peakGrowth = 0; // How far the peak memory of the process went up during this input
+		bool accepted = false;
+	};
+
+	std::vector<outcome> outcomes;
+	for (const auto& entry : std::filesystem::recursive_directory_iterator(directory))
+	{
+		if (!entry.is_regular_file())
+			continue;
+
+		std::ifstream file(entry.path(), std::ios::binary);
+		const std::vector<byte> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		outcome result;
+		result.path = entry.path().string();
+		result.bytes = bytes.size();
+		const size_t peakBefore = peakMemory();
+		const auto start = std::chrono::steady_clock::now();
+		std::string error;
+		result.accepted = run(bytes.data(), bytes.size(), error);
+		result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		result.peakGrowth = peakMemory() - peakBefore;
+		outcomes.push_back(std::move(result));
+	}
+
+	size_t totalBytes = 0;
+	size_t accepted = 0;
+	double totalSeconds = 0;
+	for (const auto& result : outcomes)
+	{
+		totalBytes += result.bytes;
+		totalSeconds += result.seconds;
+		accepted += result.accepted ? 1 : 0;
+	}
+
+	const double megabytes = totalBytes / (1024.0 * 1024.0);
+	out << std::fixed << std::setprecision(3);
+	out << outcomes.size() << " inputs, " << megabytes << " MB in " << totalSeconds << " s";
+	if (totalSeconds > 0)
+		out << " (" << megabytes / totalSeconds << " MB/s)";
+	out << "; " << accepted << " decoded, " << outcomes.size() - accepted << " rejected" << std::endl;
+	out << "Peak memory: " << peakMemory() / (1024.0 * 1024.0) << " MB" << std::endl;
+
+	const size_t shown = std::min(listed, outcomes.size());
+	std::partial_sort(outcomes.begin(), outcomes.begin() + shown, outcomes.end(),
+		[](const outcome& a, const outcome& b) { return a.seconds > b.seconds; });
+	out << "Slowest inputs:" << std::endl;
+	for (size_t i = 0; i < shown; ++i)
+		out << "  " << outcomes[i].seconds << " s  " << outcomes[i].bytes << " bytes  " << outcomes[i].path << std::endl;
+
+	std::partial_sort(outcomes.begin(), outcomes.begin() + shown, outcomes.end(),
+		[](const outcome& a, const outcome& b) { return a.peakGrowth > b.peakGrowth; });
+	out << "Inputs that raised the peak memory most:" << std::endl;
+	for (size_t i = 0; i < shown && outcomes[i].peakGrowth != 0; ++i)
+		out << "  +" << outcomes[i].peakGrowth / (1024.0 * 1024.0) << " MB  " << outcomes[i].path << std::endl;
+}
+
+///	<summary>The most memory the process has held at once so far, in bytes.</summary>
+size_t FuzzHarness::peakMemory()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	rusage usage{};
+	getrusage(RUSAGE_SELF, &usage);
+	return (size_t)usage.ru_maxrss * 1024; // Reported in kilobytes
+#endif
+}
+
+///	<summary>The libFuzzer entry point. Rejected modules are an expected outcome.</summary>
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+	std::string error;
+	FuzzHarness::run(data, size, error);
+	return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef FUZZHARNESS_H
+#define FUZZHARNESS_H
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+typedef unsigned char byte;
+
+///	<summary>
+///	Runs the whole decompiler over modules that may be broken on purpose.<br>
+///	'run' takes a module in memory through sectioning, decoding, the simplifier,
+///	every backend, the profiler and the symbolizer. A module rejected with an
+///	exception is fine. A crash, a hang, or memory running away is a bug. It backs
+///	the libFuzzer entry point in FuzzHarness.cpp; for a fuzzing build, compile
+///	every file except main.cpp with -fsanitize=fuzzer (clang) or /fsanitize=fuzzer
+///	(MSVC).<br>
+///	'runCorpus' does the same for every file under a directory. It reports the
+///	throughput, the slowest inputs, and the inputs that pushed the peak memory of
+///	the process up the most, so that slow or hungry inputs can be found and pinned down.
+///	</summary>
+class FuzzHarness
+{
+public:
+	static bool run(const byte* data, size_t size, std::string& error);
+	static void runCorpus(const std::string& directory, std::ostream& out, size_t listed = 10);
+	static size_t peakMemory();
+};
+
+#endif // FUZZHARNESS_H
@@ -0,0 +1,70 @@
+#include "IndirectTable.h"
+#include <algorithm>
+
+///	<summary>Applies the placed element segments in order, so later ones overwrite the
+///	slots of earlier ones, then buckets what ended up in each table by type.</summary>
+IndirectTable::IndirectTable(const std::vector<elementSegment>& elements, const TypeTable* types)
+	: types(types)
+{
+	for (const auto& segment : elements)
+	{
+		if (!segment.placed || segment.funcs.empty())
+			continue;
+
+		if (segment.table >= slots.size())
+			slots.resize(segment.table + 1);
+
+		auto& table = slots[segment.table];
+		const uint64_t end = std::min<uint64_t>((uint64_t)segment.offset + segment.funcs.size(), maxSlots);
+		if (end > table.size())
+			table.resize((size_t)end, elementSegment::noFunction);
+
+		for (uint64_t i = segment.offset; i < end; ++i)
+			table[(size_t)i] = segment.funcs[(size_t)(i - segment.offset)];
+	}
+
+	buckets.resize(slots.size());
+	for (size_t t = 0; t < slots.size(); ++t)
+	{
+		for (uint32_t func : slots[t])
+		{
+			const uint32_t type = types != nullptr && func != elementSegment::noFunction ? types->funcType(func) : TypeTable::noType;
+			if (type != TypeTable::noType)
+				buckets[t][type].push_back(func);
+		}
+
+		// A function can sit in several slots, but is only a candidate once
+		for (auto& bucket : buckets[t])
+		{
+			std::sort(bucket.second.begin(), bucket.second.end());
+			bucket.second.erase(std::unique(bucket.second.begin(), bucket.second.end()), bucket.second.end());
+		}
+	}
+}
+
+///	<summary>The function in a slot of a table, or noFunction if the slot is empty.</summary>
+uint32_t IndirectTable::slot(uint32_t table, uint32_t index) const
+{
+	if (table >= slots.size() || index >= slots[table].size())
+		return elementSegment::noFunction;
+
+	return slots[table][index];
+}
+
+///	<summary>Number of slots the element section reaches in a table.</summary>
+size_t IndirectTable::size(uint32_t table) const
+{
+	return table < slots.size() ? slots[table].size() : 0;
+}
+
+///	<summary>The functions a call_indirect through 'table' with type section index
+///	'typeIdx' can reach, in index order. Empty when nothing matches.</summary>
+const std::vector<uint32_t>& IndirectTable::candidates(uint32_t table, uint32_t typeIdx) const
+{
+	static const std::vector<uint32_t> nothing;
+	if (types == nullptr || table >= buckets.size())
+		return nothing;
+
+	auto found = buckets[table].find(types->canonicalType(typeIdx));
+	return found != buckets[table].end() ? found->second : nothing;
+}
@@ -0,0 +1,47 @@
+#ifndef INDIRECTTABLE_H
+#define INDIRECTTABLE_H
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "TypeTable.h"
+
+///	<summary>An entry of the element section: the functions put in a run of table slots.</summary>
+struct elementSegment
+{
+	static constexpr uint32_t noFunction = UINT32_MAX; // A null entry, or one that couldn't be worked out
+
+	uint32_t table = 0;
+	uint32_t offset = 0; // The first slot. Only meaningful when 'placed'.
+	bool placed = false; // Passive and declarative segments, and ones placed by an imported global, aren't
+	std::vector<uint32_t> funcs{};
+};
+
+///	<summary>
+///	What the module's tables hold once the element section has been applied, so
+///	indirect calls can be narrowed down to the functions they may reach.<br>
+///	Every table is flattened into an array of function indices by slot. The
+///	functions of each table are also bucketed by canonical type, which is all a
+///	call_indirect can check, so finding the candidates of a call is one hash
+///	lookup however big the table is.<br>
+///	Built once by the Mediator and only read afterwards.
+///	</summary>
+class IndirectTable
+{
+public:
+	IndirectTable() = default;
+	IndirectTable(const std::vector<elementSegment>& elements, const TypeTable* types);
+
+	uint32_t slot(uint32_t table, uint32_t index) const;
+	size_t size(uint32_t table) const;
+	const std::vector<uint32_t>& candidates(uint32_t table, uint32_t typeIdx) const;
+
+	// Slots past this are not tracked. No real table comes near it.
+	static constexpr uint32_t maxSlots = 1 << 24;
+
+private:
+	const TypeTable* types = nullptr;
+	std::vector<std::vector<uint32_t>> slots; // Table -> slot -> function index
+	std::vector<std::unordered_map<uint32_t, std::vector<uint32_t>>> buckets; // Table -> canonical type -> functions, sorted
+};
+
+#endif // INDIRECTTABLE_H
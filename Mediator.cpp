@@ -1,11 +1,33 @@
 #include "Mediator.h"
-
-Mediator::Mediator(Sectioner* worker)
+#include "OutputPipeline.h"
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+///	<summary>Reads every function out of the module. Unless told otherwise the bodies are
+///	decoded straight away; callers that only need some of them (see Baseline) can pass
+///	false and decode the ones they want with decodeFunction.</summary>
+Mediator::Mediator(Sectioner* worker, bool decodeAll, decodeOptions options)
 {
 	this->worker = worker; // Save the reference to the worker
+	this->options = options;
 
 	// Using the reader, extract the sections of the functions out of the binary
 	extractFunctions();
+
+	// The rest of the module. Globals come first, since the others can be placed by them.
+	extractGlobals();
+	extractElements();
+	extractData();
+	indirect = IndirectTable(elements, typeTable.get());
+	applyBudget();
+
+	if (!decodeAll)
+		return;
+
+	for (auto& func : funcs)
+		decodeFunction(func.first);
 }
 
 int Mediator::getIdxInputSize(int index)
@@ -13,81 +35,290 @@ int Mediator::getIdxInputSize(int index)
 	return funcs[index].getInputSize();
 }
 
+///	<summary>Number of functions in the module, imported ones included.</summary>
+int Mediator::getFunctionCount() const
+{
+	return (int)funcs.size();
+}
+
+Function& Mediator::getFunction(int index)
+{
+	return funcs.at(index);
+}
+
+const Function& Mediator::getFunction(int index) const
+{
+	return funcs.at(index);
+}
+
+///	<summary>Decodes the body of one function if that has not happened yet. A malformed
+///	body ends up as an error node in that function and nothing else is affected.</summary>
+void Mediator::decodeFunction(int index)
+{
+	Function& func = funcs.at(index);
+	if (func.isImported || func.isDecoded())
+		return;
+
+	func.setArenaLimit(arenaLimit);
+	func.decodeFunction();
+	if (!options.simplify || !func.getError().empty())
+		return;
+
+	// The simplifier rewrites in place, so if it gives up halfway the function is decoded again as is
+	try
+	{
+		Simplifier::run(func);
+	}
+	catch (const std::exception&)
+	{
+		func.decodeFunction();
+	}
+}
+
+///	<summary>Under a memory budget, lets go of the statements of a function once the caller
+///	is done with them, so only the functions being worked on are held decoded. Without one
+///	decoded functions are kept.</summary>
+void Mediator::releaseFunction(int index)
+{
+	if (options.maxMemory != 0)
+		funcs.at(index).release();
+}
+
+///	<summary>Works out what is left of the memory budget for decoding. The bodies and the
+///	data section stay in memory the whole run, so they are taken off first; whatever
+///	remains is what one function at a time may use for its statements.</summary>
+void Mediator::applyBudget()
+{
+	if (options.maxMemory == 0)
+		return;
+
+	size_t resident = 0;
+	for (int id : { 0x0a, 11 })
+	{
+		const sectionEntry* entry = worker->findSection(id);
+		if (entry != nullptr)
+			resident += entry->length;
+	}
+
+	if (resident >= options.maxMemory)
+		throw std::exception("The module needs more memory than the budget before anything is decoded");
+	arenaLimit = options.maxMemory - resident;
+}
+
+///	<summary>Decodes and renders every defined function and writes them out in index order.
+///	Functions are handed out to 'threads' workers one at a time and each renders into
+///	its own buffer; an OutputPipeline writes the buffers out in order as they complete,
+///	so output starts before the last function is done and is the same whatever the
+///	number of threads.</summary>
+void Mediator::emitFunctions(Emitter& emitter, std::ostream& out, unsigned threads)
+{
+	emitter.setFunctionNames(getFunctionNames());
+	emitter.setDataSegments(&data);
+	emitter.setIndirectTable(&indirect);
+
+	std::vector<int> defined;
+	for (const auto& func : funcs)
+	{
+		if (!func.second.isImported)
+			defined.push_back(func.first);
+	}
+
+	if (threads == 0)
+		threads = 1;
+
+	// Under a budget every worker holds one function, so they share what is left for
+	// decoding, and the writer only keeps a few rendered functions waiting
+	const size_t wholeLimit = arenaLimit;
+	arenaLimit /= threads;
+	const size_t window = options.maxMemory != 0 ? (size_t)threads : 16 * (size_t)threads;
+
+	// Enough room that no worker waits on the writer unless one function is far slower than the rest
+	OutputPipeline pipeline(out, defined.size(), window);
+	std::atomic<size_t> nextFunc{ 0 };
+	std::exception_ptr failure;
+	std::mutex failureLock;
+	auto work = [&]()
+	{
+		try
+		{
+			for (size_t i = nextFunc++; i < defined.size(); i = nextFunc++)
+			{
+				pipeline.waitForRoom(i);
+				std::string chunk;
+				decodeFunction(defined[i]);
+				emitter.emit(funcs.at(defined[i]), defined[i], chunk);
+				releaseFunction(defined[i]);
+				chunk += '\n';
+				pipeline.submit(i, std::move(chunk));
+			}
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> hold(failureLock);
+			if (!failure)
+				failure = std::current_exception();
+			nextFunc = defined.size(); // Stop handing out work
+
+			// This position will never be written, so workers waiting for room past it have to be woken
+			pipeline.abort();
+		}
+	};
+
+	if (threads == 1)
+		work();
+	else
+	{
+		std::vector<std::thread> workers;
+		for (unsigned i = 0; i < threads; ++i)
+			workers.emplace_back(work);
+		for (auto& worker : workers)
+			worker.join();
+	}
+	arenaLimit = wholeLimit;
+
+	if (failure)
+	{
+		pipeline.abort();
+		std::rethrow_exception(failure);
+	}
+	pipeline.finish();
+}
+
+///	<summary>The name of every function by index. Unnamed functions have an empty name.</summary>
+std::vector<std::string_view> Mediator::getFunctionNames() const
+{
+	std::vector<std::string_view> names(funcs.size());
+	for (const auto& func : funcs)
+	{
+		if (func.first >= 0 && func.first < (int)names.size())
+			names[func.first] = func.second.getTitle();
+	}
+	return names;
+}
+
 void Mediator::extractFunctions()
 {
 	// First, extract the signatures and names out of the functions.
 	extractSignatures();
 	extractNames();
 
-	// Now that we have the basis setup, we need to put the bytecode into each function
+	// Now that we have the basis setup, we need to put the bytecode into each function.
+	// The index finds every body in one pass over the size prefixes, unless a saved one
+	// for this very code section was handed over.
 	std::vector<byte> byteString = worker->getSection(0x0a);
-
-	// The first byte is the number of functions that will get extracted
-	int offset = 0;
-	byte numberOfFuncs = byteString[offset];
-	offset++;
-
-	// for each function. . .
-	for(int i = 0; i < numberOfFuncs; ++i)
+	const sectionEntry* code = worker->findSection(0x0a);
+	const uint32_t base = code != nullptr ? code->offset : 0;
+	if (!loadBodyIndex(base, (uint32_t)byteString.size()))
+		bodies = BodyIndex::build(byteString, base);
+
+	// Bodies belong to the defined functions, which come after the imported ones
+	int defined = 0;
+	for (auto& func : funcs)
 	{
-		// Check if the function at the index was imported. If it was, extend the number of funcs
-		if(funcs[i].isImported)
-		{
-			numberOfFuncs++;
+		if (func.second.isImported)
 			continue;
-		}
 
-		// The first four bytes are the encoded function length, so extract that.
-		char lebLength[4];
-		for (char& k : lebLength)
+		// A body that runs off the end of the section leaves no way to find the ones after it
+		Function& target = func.second;
+		if (defined >= (int)bodies.size())
 		{
-			k = byteString[offset];
-			offset++;
+			target.fail("Function body runs past the end of the code section", 0);
+			continue;
 		}
-		int size = u_decLEB32(lebLength);
-		int nextStop = size + offset + 1;
 
-		// The next byte is padding, so we skip it
-		offset++;
+		const bodyEntry& entry = bodies.at(defined++);
+		int offset = (int)(entry.locals - base);
+		const int nextStop = offset + entry.size;
 
-		// The next set of bytes is the locals vector, which defines how many of
-		// each variable type can be defined in each function body.
-		// We do not care about this at all, so we have to skip the vector.
-		byte localSize = byteString[offset];
-		offset++;
+		// The hash covers the locals too, since they are part of what gets printed.
+		const uint64_t hash = hashBytes(byteString.data() + offset, entry.size);
 
-		if(localSize != 0x00)
+		// The next set of bytes is the locals vector, which defines how many of
+		// each variable type can be defined in each function body. A bad one only
+		// costs this function, since the size says where the next body starts.
+		try
 		{
-			// We can do some math here to skip forward, if we establish a few things:
-			//		1) The vector represents how many different types there are
-			//		2) There can be four types max
-			//		3) Each different type is represented in two bytes max.
-			// Therefore, we can adjust the offset by (localSize) * 2
-			// 6 initial: 6 + (1 * 2) = 8
-			offset += (localSize * 2);
+			offset += extractLocals(byteString, offset, target);
 		}
-		// If the size is zero, we do not need to move.
-
-		// Now, copy a section into a new vector and pass it to the function 
-		std::vector<byte> byteCode;
-		for(int k = 0; offset < nextStop; ++k)
+		catch (const std::exception& e)
 		{
-			byteCode.push_back(byteString[offset]);
-			offset++;
+			target.fail(e.what(), 0);
+			continue;
 		}
 
-		// Send the function byte code to the function representation for it to do it's thing.
-		funcs[i].decodeFunction(byteCode);
-		std::cout << funcs[i] << std::endl;
+		// Hand the byte code to the function. Decoding it is left for later.
+		std::vector<byte> byteCode(byteString.begin() + std::min(offset, nextStop), byteString.begin() + nextStop);
+		target.setBody(std::move(byteCode), hash);
 	}
 }
 
+///	<summary>Takes the body index from options.bodyIndexFile when there is one and it was
+///	saved for a code section at the same place and of the same size. The index is only
+///	a shortcut, so a file that is missing, damaged or stale just means scanning.</summary>
+bool Mediator::loadBodyIndex(uint32_t sectionOffset, uint32_t sectionLength)
+{
+	if (options.bodyIndexFile.empty())
+		return false;
+
+	try
+	{
+		BodyIndex saved = BodyIndex::load(options.bodyIndexFile);
+		if (!saved.matches(sectionOffset, sectionLength))
+			return false;
+
+		bodies = std::move(saved);
+		return true;
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+}
+
+/// <summary>Decodes the locals declaration at the start of a function body and hands it
+/// to the function. Each entry is a LEB count followed by a value type, and entries
+/// are kept as runs so a function declaring thousands of locals stays small.
+/// Returns the number of bytes the declaration occupied.</summary>
+int Mediator::extractLocals(const std::vector<byte>& byteString, int offset, Function& func)
+{
+	const int start = offset;
+	int numberOfRuns;
+	offset += getNextu32(byteString, offset, numberOfRuns);
+
+	std::vector<localRun> runs;
+	uint64_t total = 0;
+	for (int k = 0; k < numberOfRuns; ++k)
+	{
+		int count;
+		offset += getNextu32(byteString, offset, count);
+		if (offset >= (int)byteString.size())
+			throw std::exception("Malformed locals declaration");
+
+		dataTypes type = valueType(byteString[offset]);
+		offset++;
+
+		// The whole function has to stay addressable with a u32 local index.
+		total += (uint32_t)count;
+		if (total > UINT32_MAX)
+			throw std::exception("Too many locals in function");
+
+		// Neighbouring runs of the same type are merged.
+		if (!runs.empty() && runs.back().type == type)
+			runs.back().count += count;
+		else
+			runs.push_back(localRun{ (uint32_t)count, type });
+	}
+
+	func.setLocals(std::move(runs));
+	return offset - start;
+}
+
 /// <summary>Now that the function definitions have been extracted, we need to figure out which
 /// two things:<br>
 ///		1) How many functions there are, and<br>
 ///		2) What type definitions each function gets.<br>
 ///	This information is contained in section 3</summary>
-void Mediator::populateFunctions(std::vector< std::pair< std::vector<dataDef>, dataDef> > pairs)
+void Mediator::populateFunctions(std::vector<signature> types)
 {
 	// Extract the byte code for section 3
 	std::vector<byte> byteCode = worker->getSection(3);
@@ -95,107 +326,120 @@ void Mediator::populateFunctions(std::vector< std::pair< std::vector<dataDef>, d
 	// The first bytes are representative of the length of the section, which is the number of defined functions in the module
 	int offset = 0;
 	int moduleSize = 0;
-	offset += getNextu32(byteCode, 0, moduleSize);
+	if (!byteCode.empty())
+		offset += getNextu32(byteCode, 0, moduleSize);
 
-	// Grab the imported size and table
+	// Imported functions come first in the function index space, so they take
+	// the lowest indices in the order they were imported.
 	auto importedFuncs = extractImports();
-	int importedSize = importedFuncs.size();
+	importedCount = (int)importedFuncs.size();
+	std::vector<uint32_t> funcTypes;
+	for (const auto& imported : importedFuncs)
+		funcTypes.push_back(imported.second);
 
-	int totalSize = moduleSize + importedSize;
-
-	// For each value from the offset to the end, we need to create a function
-	// with the definitions provided in our pairs array.
+	// Every entry of section 3 is the type index of the next defined function.
 	for(int i = 0; i < moduleSize; ++i)
 	{
-		byte idx = byteCode[offset];
-		offset++;
+		if (offset >= (int)byteCode.size())
+			throw std::exception("Malformed function section");
 
-		// Check if the idx is
-		
-		// Figure out of the idx is present in the pairs or in the importedFuncions table
-		Function next;
-		next = Function(pairs[idx].first, pairs[idx].second);
-	
-		//Function next = Function(pairs[idx].first, pairs[idx].second);
-		funcs[idx] = next;
-		//funcs.push_back(next);
+		int typeIdx;
+		offset += getNextu32(byteCode, offset, typeIdx);
+		funcTypes.push_back(typeIdx);
 	}
 
-	// Do a second pass to extract the imported functions. This part is simple; test up to the total size and
-	// insert a function if it exists in the imported table
-	for(int i = 0; i < totalSize; ++i)
+	// The table is frozen from here on, so every function can share it.
+	typeTable = std::make_shared<const TypeTable>(std::move(types), std::move(funcTypes));
+
+	for(int i = 0; i < (int)typeTable->funcCount(); ++i)
 	{
-		if(importedFuncs.find(i) != importedFuncs.end())
+		const uint32_t typeIdx = typeTable->funcType(i);
+		if (typeIdx == TypeTable::noType)
+			throw std::exception("Function refers to a type that does not exist");
+
+		// Functions only keep the index of their signature in the shared table.
+		Function next = Function(typeTable.get(), typeIdx);
+
+		if(i < (int)importedFuncs.size())
 		{
-			Function next = Function(pairs[i].first, pairs[i].second);
-			next.setTitle(importedFuncs[i]);
+			next.setTitle(importedFuncs[i].first);
 			next.isImported = true;
-			funcs[i] = next;
 		}
+		funcs[i] = std::move(next);
 	}
-	
 }
 
 /// <summary>Some modules may contain references to other modules and their functions.
 /// In this case, the functions used become part of THIS modules function table.
 /// Therefore, we have to load the import section and parse through it to add
-/// references to functions that we have no definition for, just a name and funcidx.</summary>
-std::map<int, std::string> Mediator::extractImports() const
+/// references to functions that we have no definition for, just a name and a type index.
+/// The position in the returned list is the function index.</summary>
+std::vector<std::pair<std::string_view, uint32_t>> Mediator::extractImports()
 {
 	// Load the byte data for this section. It it is empty, return.
-	std::map<int, std::string> importedFuncs;
+	std::vector<std::pair<std::string_view, uint32_t>> importedFuncs;
 	std::vector<byte> byteString = worker->getSection(0x02);
 	if (byteString.empty())
 		return importedFuncs;
 
-	// The first byte represents the number of imported functions to be used in our module
-	int numberOfFuncs;
-	int offset = getNextu32(byteString, 0, numberOfFuncs);
+	// The first byte represents the number of imports in our module
+	int numberOfImports;
+	int offset = getNextu32(byteString, 0, numberOfImports);
 
-	// Now we loop
-	for(int i = 0; i < numberOfFuncs; ++i)
+	// Now we loop, building each "module::name" in the same buffer
+	std::string fullName;
+	for(int i = 0; i < numberOfImports; ++i)
 	{
-		std::stringstream ss;
 		// The first byte represents the length of the module string
 		int strLen;
 		offset += getNextu32(byteString, offset, strLen);
-		int stop = offset + strLen;
-
-		// Loop over that number of letters.
-		for(int k = offset; k < stop; ++k)
-		{
-			ss << (char)byteString[k];
-		}
+		if (strLen < 0 || strLen > (int)byteString.size() - offset)
+			throw std::exception("Malformed import section");
+		fullName.assign((const char*)&byteString[offset], strLen);
 		offset += strLen;
 
 		// The next byte is the length of the next part of the name
 		offset += getNextu32(byteString, offset, strLen);
-		stop = offset + strLen;
-
-		// Loop over all the letters
-		ss << "::";
-		for(int k = offset; k < stop; ++k)
-		{
-			ss << (char)byteString[k];
-		}
+		if (strLen < 0 || strLen >= (int)byteString.size() - offset)
+			throw std::exception("Malformed import section");
+		fullName += "::";
+		fullName.append((const char*)&byteString[offset], strLen);
 		offset += strLen;
 
-		// The next byte tells us if it is a function or something else. For now, we only care about 0x00
+		// The next byte tells us what is being imported. Only functions
+		// are kept, but everything else has to be stepped over correctly.
 		byte importDesc = byteString[offset];
 		offset++;
-		if (importDesc == 0x00)
+		int value;
+		switch (importDesc)
 		{
-			// The next byte is the funcidx that we need
-			//Function next = Function();
-			//next.setTitle(ss.str());
-			//next.isImported = true;
-
-			byte funcidx = byteString[offset];
+		case 0x00: // Function: the type index of its signature
+			offset += getNextu32(byteString, offset, value);
+			importedFuncs.emplace_back(names.view(fullName), value);
+			break;
+		case 0x01: // Table: a reference type followed by limits
 			offset++;
-			importedFuncs[funcidx] = ss.str();
-		}
-		else
+			[[fallthrough]]; // to the limits
+		case 0x02: // Memory: just limits
+		{
+			if (offset >= (int)byteString.size())
+				throw std::exception("Malformed import section");
+			byte hasMax = byteString[offset];
 			offset++;
+			offset += getNextu32(byteString, offset, value);
+			if (hasMax & 0x01)
+				offset += getNextu32(byteString, offset, value);
+			break;
+		}
+		case 0x03: // Global: a value type and its mutability. Where it starts is up to the importer.
+			if (offset + 2 > (int)byteString.size())
+				throw std::exception("Malformed import section");
+			globals.push_back(globalDef{ valueType(byteString[offset]), byteString[offset + 1] == 0x01, true });
+			offset += 2;
+			break;
+		default:
+			throw std::exception("Malformed import section");
+		}
 	}
 
 	return importedFuncs;
@@ -203,123 +447,79 @@ std::map<int, std::string> Mediator::extractImports() const
 
 /// <summary>
 /// Working with section 01, we can extract what inputs 
-/// and outputs the function will work with for each funcidx. Also
-/// extracts the number of functions present in the module.
+/// and outputs the function will work with for each type index.
 /// </summary>
 void Mediator::extractSignatures()
 {
 	// Access section 1 from the reader.
 	std::vector<byte> byteString = worker->getSection(0x01);
-	std::vector<std::pair<std::vector<dataDef>, dataDef>> types; // This definition is to help match multiple functions with the same definitions.
-
-	// The first byte is the section ID
-	// The next 4 bytes denote the length of the section, followed by padding zeros
+	std::vector<signature> types; // Functions refer to these by index, so several can share one.
 
 	// The vector starts at the first byte we can look at, so that's the length.
-	numberOfFuncs = byteString[0x00]; // It's also the number of function signature's present.
-	//funcs.resize(numberOfFuncs);
+	int numberOfTypes = 0; // The number of function signature's present.
+	int offset = 0;
+	if (!byteString.empty())
+		offset += getNextu32(byteString, 0, numberOfTypes);
 
-	// Now, for each func determine the input and output signatures of each
-	int offset = 0x01;
-	for(int i = 0; i < numberOfFuncs; ++i)
+	// Now, for each type determine the input and output signatures
+	for(int i = 0; i < numberOfTypes; ++i)
 	{
 		std::vector<dataDef> inputs;
 		dataDef output;
 
 		// First byte should be 0x60
-		if (byteString[offset] != 0x60)
+		if (offset >= (int)byteString.size() || byteString[offset] != 0x60)
 			throw std::exception("Malformed signature section");
 
-		// Next is a vector length
-		offset++;
-		byte vectorLength = byteString[offset]; // TODO: Modify this so that it works with u32 bit numbers up to 4 bytes long
+		// Next is a vector length. Everything from here to the end of the results is the encoding.
 		offset++;
+		const int encodingStart = offset;
+		int vectorLength;
+		offset += getNextu32(byteString, offset, vectorLength);
+		if (vectorLength < 0 || vectorLength > (int)byteString.size() - offset)
+			throw std::exception("Malformed signature section");
 
 		// The next vectorLength bytes represent the signatures of the incoming variables.
 		// If it is zero, there are no inputs.
-		if (vectorLength != 0x00)
+		for (int k = 0; k < vectorLength; ++k)
 		{
-			for (int k = 0; k < vectorLength; ++k)
-			{
-				byte workingByte = byteString[offset];
-				offset++;
-
-				// String stream for ease of naming.
-				std::stringstream ss;
-
-				// Determine the correct enum for the data type
-				if (workingByte == 0x7f)
-				{
-					ss << "__i32_invar_" << k;
-					inputs.push_back(dataDef{ dataTypes::i32, false, ss.str() });
-				}
-				else if (workingByte == 0x7e)
-				{
-					ss << "__i64_invar_" << k;
-					inputs.push_back(dataDef{ dataTypes::i64, false, ss.str() });
-				}
-				else if (workingByte == 0x7d)
-				{
-					ss << "__f32_invar_" << k;
-					inputs.push_back(dataDef{ dataTypes::f32, false, ss.str() });
-				}
-				else if (workingByte == 0x7c)
-				{
-					ss << "__f64_invar_" << k;
-					inputs.push_back(dataDef{ dataTypes::f64, false, ss.str() });
-				}
-
-
-			}
+			byte workingByte = byteString[offset];
+			offset++;
 
-			// The next vector represents the return type
-		}
-		else
-		{
-			// If there are no inputs, pass a void type
-			inputs.push_back(dataDef{ none, false, "void" });
-			//offset++;
+			// Determine the correct enum for the data type. The names repeat
+			// across signatures, so they are interned.
+			dataTypes type = valueType(workingByte);
+			std::string name = std::string("__") + typeName(type) + "_invar_" + std::to_string(k);
+			inputs.push_back(dataDef{ type, false, names.view(name) });
 		}
 
 		// The next vector represents the return type
-		vectorLength = byteString[offset];
-		offset++;
+		offset += getNextu32(byteString, offset, vectorLength);
+		if (vectorLength < 0 || vectorLength > (int)byteString.size() - offset)
+			throw std::exception("Malformed signature section");
 		if(vectorLength != 0x00)
 		{
 			byte workingByte = byteString[offset];
-			offset++;
 
 			// Determine what type is being returned.
-			if (workingByte == 0x7f)
-				output = dataDef{ dataTypes::i32, false, "__i32_out" };
-			else if (workingByte == 0x7e)
-				output = dataDef{ dataTypes::i64, false, "__i64_out" };
-			else if (workingByte == 0x7d)
-				output = dataDef{ dataTypes::f32, false, "__f32_out"};
-			else if (workingByte == 0x7c)
-				output = dataDef{ dataTypes::f64, false, "__f64_out"};
+			dataTypes type = valueType(workingByte);
+			output = dataDef{ type, false, names.view(std::string("__") + typeName(type) + "_out") };
+
+			// Only the first result is shown, but all of them have to be skipped.
+			offset += vectorLength;
 		}
 		else
 		{
-			output = dataDef{ none, false, "void" };
-			//offset++;
+			output = dataDef{ none, false, names.view("void") };
 		}
-		// What we have now is a pair assigned to a value
-		// eg: [key] : [std::pair(inputs, outputs)]
-		// From here, we need to look at another section to determine the which function gets what pair definition
-		types.emplace_back(inputs, output);
-
-
-		// Finally, create a new function and add it to the functions vector.
-		//Function next = Function(inputs, output);
-		//funcs[i] = next;
+		// What we have now is a signature assigned to a type index.
+		// From here, we need to look at another section to determine the which function gets what definition
+		std::vector<byte> encoding(byteString.begin() + encodingStart, byteString.begin() + offset);
+		types.push_back(signature{ inputs, output, std::move(encoding) });
 	}
 
-	// Parse through the import section if it exists to ensure we have all the function definitions in our vector.
-	//extractImports(types);
-
 	// Give each function their typing
-	populateFunctions(types);
+	populateFunctions(std::move(types));
 }
 
 /// <summary>
@@ -330,41 +530,323 @@ void Mediator::extractNames()
 {
 	// For this, we need to look at the bytes present in section 7
 	std::vector<byte> byteString = worker->getSection(7);
+	if (byteString.empty())
+		return;
+
 	// Figure out how many items are being exported.
-	byte numberOfExports = byteString[0];
+	int numberOfExports;
+	int offset = getNextu32(byteString, 0, numberOfExports);
 
 	// Iterate and extract all the names
-	int offset = 1;
 	for(int i = 0; i < numberOfExports; ++i)
 	{
 		// Start by grabbing the name length
-		byte nameLength = byteString[offset];
-		offset++;
-		int initialOffset = offset;
+		int nameLength;
+		offset += getNextu32(byteString, offset, nameLength);
+		if (nameLength < 0 || nameLength >= (int)byteString.size() - offset)
+			throw std::exception("Malformed export section");
 
-		// Extract the name into a std::string.
-		std::stringstream ss;
-
-		while(offset < (initialOffset + nameLength))
-		{
-			ss << (char)byteString[offset];
-			offset++;
-		}
+		// The name is interned straight from the section bytes.
+		std::string_view name((const char*)&byteString[offset], nameLength);
+		offset += nameLength;
 
 		// Grab the idxType byte
 		byte idxType = byteString[offset];
 		offset++;
 
 		// Grab the idxValue
-		byte idxValue = byteString[offset];
-		offset++;
+		int idxValue;
+		offset += getNextu32(byteString, offset, idxValue);
 
 		// Attach the names to the corresponding functions.
 		// Only do this operation if the idx corresponds to a function
 		if(idxType == 0x00)
 		{
-			funcs[idxValue].setTitle(ss.str());
+			if (idxValue < 0 || idxValue >= (int)funcs.size())
+				throw std::exception("Export refers to a function that does not exist");
+
+			funcs[idxValue].setTitle(names.view(name));
 		}
 
 	}
 }
+
+const std::vector<globalDef>& Mediator::getGlobals() const
+{
+	return globals;
+}
+
+const std::vector<elementSegment>& Mediator::getElements() const
+{
+	return elements;
+}
+
+const DataSegments& Mediator::getDataSegments() const
+{
+	return data;
+}
+
+const IndirectTable& Mediator::getIndirectTable() const
+{
+	return indirect;
+}
+
+///	<summary>Where each defined function's body is in the file, in function order.</summary>
+const BodyIndex& Mediator::getBodyIndex() const
+{
+	return bodies;
+}
+
+///	<summary>The function index of a position in the body index. Bodies only exist for
+///	the defined functions, which come after the imported ones.</summary>
+int Mediator::getBodyFunction(int body) const
+{
+	return importedCount + body;
+}
+
+///	<summary>The switches the module was loaded with.</summary>
+const decodeOptions& Mediator::getOptions() const
+{
+	return options;
+}
+
+///	<summary>Hash of everything outside the function bodies that can show up in their
+///	printed text: types, imports, tables, memories, globals, exports, elements, data and
+///	the name section. The function and code sections are left out, since a body is
+///	already covered by its own hash.</summary>
+uint64_t Mediator::getModuleHash() const
+{
+	static const int printedSections[] = { 1, 2, 4, 5, 6, 7, 9, 11 };
+
+	uint64_t hash = hashBytes(nullptr, 0);
+	for (int id : printedSections)
+	{
+		const std::vector<byte> contents = worker->getSection(id);
+		// The id and length keep bytes from moving between sections unnoticed
+		const uint32_t length = (uint32_t)contents.size();
+		const byte marker[] = { (byte)id, (byte)length, (byte)(length >> 8), (byte)(length >> 16), (byte)(length >> 24) };
+		hash = hashBytes(marker, sizeof(marker), hash);
+		hash = hashBytes(contents.data(), contents.size(), hash);
+	}
+
+	const std::vector<byte> nameSection = worker->getCustomSection("name");
+	return hashBytes(nameSection.data(), nameSection.size(), hash);
+}
+
+/// <summary>Evaluates the constant expression at 'offset', up to and including its end.
+/// 'known' is cleared when the value depends on something outside the module, like an
+/// imported global. Returns the number of bytes the expression took.</summary>
+int Mediator::readConstExpr(const std::vector<byte>& byteString, int offset, bool& known, int64_t& value) const
+{
+	const int start = offset;
+	std::vector<int64_t> stack; // Extended constant expressions can add, subtract and multiply
+	known = true;
+	for (;;)
+	{
+		if (offset >= (int)byteString.size())
+			throw std::exception("Constant expression runs past the end of its section");
+
+		const byte op = byteString[offset];
+		offset++;
+		int64_t number = 0;
+		int index;
+		switch (op)
+		{
+		case 0x0b: // end
+			known = known && stack.size() == 1;
+			value = stack.empty() ? 0 : stack.back();
+			return offset - start;
+		case 0x41: // i32.const
+			offset += getNexts64(byteString, offset, number);
+			stack.push_back((int32_t)number);
+			break;
+		case 0x42: // i64.const
+			offset += getNexts64(byteString, offset, number);
+			stack.push_back(number);
+			break;
+		case 0x43: // f32.const and f64.const keep their raw bits
+		case 0x44:
+		{
+			const int length = op == 0x43 ? 4 : 8;
+			if (offset + length > (int)byteString.size())
+				throw std::exception("Constant expression runs past the end of its section");
+			for (int i = 0; i < length; ++i)
+				number |= (int64_t)byteString[offset + i] << (8 * i);
+			offset += length;
+			stack.push_back(number);
+			break;
+		}
+		case 0x23: // global.get only gives something when the global never changes
+			offset += getNextu32(byteString, offset, index);
+			if (index < 0 || index >= (int)globals.size() || !globals[index].known || globals[index].isMutable)
+				known = false;
+			else
+				number = globals[index].value;
+			stack.push_back(number);
+			break;
+		case 0xd2: // ref.func
+			offset += getNextu32(byteString, offset, index);
+			stack.push_back((uint32_t)index);
+			break;
+		case 0xd0: // ref.null has no value worth knowing
+			offset++;
+			known = false;
+			stack.push_back(0);
+			break;
+		case 0x6a: case 0x6b: case 0x6c: // i32.add, sub and mul
+		case 0x7c: case 0x7d: case 0x7e: // i64.add, sub and mul
+		{
+			if (stack.size() < 2)
+				throw std::exception("Malformed constant expression");
+			const uint64_t rhs = stack.back();
+			stack.pop_back();
+			const uint64_t lhs = stack.back();
+			const int kind = op < 0x7c ? op - 0x6a : op - 0x7c;
+			uint64_t result = kind == 0 ? lhs + rhs : kind == 1 ? lhs - rhs : lhs * rhs;
+			stack.back() = op < 0x7c ? (int64_t)(int32_t)(uint32_t)result : (int64_t)result;
+			break;
+		}
+		default:
+			throw std::exception("Unsupported instruction in constant expression");
+		}
+	}
+}
+
+/// <summary>Section 6 holds the globals the module defines, after the imported ones:
+/// each is a value type, whether it can change, and the expression that sets it.</summary>
+void Mediator::extractGlobals()
+{
+	std::vector<byte> byteString = worker->getSection(6);
+	if (byteString.empty())
+		return;
+
+	int numberOfGlobals;
+	int offset = getNextu32(byteString, 0, numberOfGlobals);
+	for (int i = 0; i < numberOfGlobals; ++i)
+	{
+		if (offset + 2 > (int)byteString.size())
+			throw std::exception("Malformed global section");
+
+		globalDef global{ valueType(byteString[offset]), byteString[offset + 1] == 0x01 };
+		offset += 2;
+		offset += readConstExpr(byteString, offset, global.known, global.value);
+		globals.push_back(global);
+	}
+}
+
+/// <summary>Section 9 fills tables with function references. The first number of each
+/// segment says how it is laid out: bit 0 is set for passive and declarative segments,
+/// bit 1 for an explicit table (or, without bit 0, declarative), and bit 2 when the
+/// entries are expressions rather than plain function indices.</summary>
+void Mediator::extractElements()
+{
+	std::vector<byte> byteString = worker->getSection(9);
+	if (byteString.empty())
+		return;
+
+	int numberOfSegments;
+	int offset = getNextu32(byteString, 0, numberOfSegments);
+	for (int i = 0; i < numberOfSegments; ++i)
+	{
+		if (offset >= (int)byteString.size())
+			throw std::exception("Malformed element section");
+
+		int flags;
+		offset += getNextu32(byteString, offset, flags);
+		if (flags < 0 || flags > 7)
+			throw std::exception("Malformed element section");
+
+		elementSegment segment;
+		const bool active = (flags & 0x01) == 0;
+		if (active)
+		{
+			if (flags & 0x02)
+			{
+				int table;
+				offset += getNextu32(byteString, offset, table);
+				segment.table = table;
+			}
+
+			int64_t start;
+			offset += readConstExpr(byteString, offset, segment.placed, start);
+			segment.offset = (uint32_t)start;
+		}
+
+		// Everything but the oldest form says what kind of element follows
+		if (flags != 0 && flags != 4)
+			offset++;
+
+		int count;
+		offset += getNextu32(byteString, offset, count);
+		if (count < 0 || count > (int)byteString.size() - offset)
+			throw std::exception("Malformed element section");
+
+		segment.funcs.reserve(count);
+		for (int k = 0; k < count; ++k)
+		{
+			if (flags & 0x04)
+			{
+				bool known;
+				int64_t func;
+				offset += readConstExpr(byteString, offset, known, func);
+				segment.funcs.push_back(known ? (uint32_t)func : elementSegment::noFunction);
+			}
+			else
+			{
+				int func;
+				offset += getNextu32(byteString, offset, func);
+				segment.funcs.push_back((uint32_t)func);
+			}
+		}
+		elements.push_back(std::move(segment));
+	}
+}
+
+/// <summary>Section 11 is the initial contents of memory. Segments are either placed at
+/// an address (flags 0, or 2 with a memory index) or passive (flags 1). The section is
+/// handed over whole, and the segments only record where their bytes are in it.</summary>
+void Mediator::extractData()
+{
+	std::vector<byte> byteString = worker->getSection(11);
+	if (byteString.empty())
+		return;
+
+	int numberOfSegments;
+	int offset = getNextu32(byteString, 0, numberOfSegments);
+	std::vector<dataSegment> segments;
+	for (int i = 0; i < numberOfSegments; ++i)
+	{
+		if (offset >= (int)byteString.size())
+			throw std::exception("Malformed data section");
+
+		int flags;
+		offset += getNextu32(byteString, offset, flags);
+		if (flags < 0 || flags > 2)
+			throw std::exception("Malformed data section");
+
+		dataSegment segment;
+		if (flags != 1)
+		{
+			int memory = 0;
+			if (flags == 2)
+				offset += getNextu32(byteString, offset, memory);
+			segment.memory = memory;
+
+			int64_t address;
+			offset += readConstExpr(byteString, offset, segment.placed, address);
+			segment.address = (uint32_t)address;
+		}
+
+		int length;
+		offset += getNextu32(byteString, offset, length);
+		if (length < 0 || length > (int)byteString.size() - offset)
+			throw std::exception("Data segment runs past the end of the data section");
+
+		segment.start = offset;
+		segment.length = length;
+		offset += length;
+		segments.push_back(segment);
+	}
+
+	data = DataSegments(std::move(byteString), std::move(segments));
+}
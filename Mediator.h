@@ -2,10 +2,36 @@
 #define MEDIATOR_H
 #include "Sectioner.h"
 #include "Function.h"
+#include "StringTable.h"
+#include "Simplifier.h"
+#include "Emitter.h"
+#include "DataSegments.h"
+#include "IndirectTable.h"
+#include "BodyIndex.h"
 #include <sstream>
 #include <map>
+#include <memory>
 
 
+///	<summary>Switches for what happens to a function after it is decoded.</summary>
+struct decodeOptions
+{
+	bool simplify = true; // Run the Simplifier over every decoded function
+	size_t maxMemory = 0; // Bytes the module may take while it is rendered, or 0 for no limit
+	std::string bodyIndexFile{}; // A saved BodyIndex to use instead of scanning, if it fits the module
+};
+
+///	<summary>A global of the module, imported ones first. The starting value is only
+///	known when the global is set by a constant expression that could be worked out.</summary>
+struct globalDef
+{
+	dataTypes type = none;
+	bool isMutable = false;
+	bool imported = false;
+	bool known = false;
+	int64_t value = 0; // The raw bits for floats
+};
+
 ///	<summary>This class will take the sections and turn them into a list of 
 ///	functions represented in the abstract. Basically, this is data
 ///	manipulation.
@@ -13,20 +39,53 @@
 class Mediator
 {
 public:
-	Mediator(Sectioner* worker);
+	Mediator(Sectioner* worker, bool decodeAll = true, decodeOptions options = decodeOptions{});
 
 	int getIdxInputSize(int index);
+	int getFunctionCount() const;
+	Function& getFunction(int index);
+	const Function& getFunction(int index) const;
+	void decodeFunction(int index);
+	void releaseFunction(int index);
+	void emitFunctions(Emitter& emitter, std::ostream& out, unsigned threads = 1);
+	std::vector<std::string_view> getFunctionNames() const;
+	const std::vector<globalDef>& getGlobals() const;
+	const std::vector<elementSegment>& getElements() const;
+	const DataSegments& getDataSegments() const;
+	const IndirectTable& getIndirectTable() const;
+	const BodyIndex& getBodyIndex() const;
+	int getBodyFunction(int body) const;
+	uint64_t getModuleHash() const;
+	const decodeOptions& getOptions() const;
 
 private:
 	void extractFunctions();
-	void populateFunctions(std::vector<std::pair<std::vector<dataDef>, dataDef>> pairs);
-	std::map<int, std::string> extractImports() const;
+	bool loadBodyIndex(uint32_t sectionOffset, uint32_t sectionLength);
+	static int extractLocals(const std::vector<byte>& byteString, int offset, Function& func);
+	void populateFunctions(std::vector<signature> types);
+	std::vector<std::pair<std::string_view, uint32_t>> extractImports();
 	void extractSignatures();
 	void extractNames();
+	void extractGlobals();
+	void extractElements();
+	void extractData();
+	int readConstExpr(const std::vector<byte>& byteString, int offset, bool& known, int64_t& value) const;
+
+	void applyBudget();
 
 	int numberOfFuncs = 0;
+	int importedCount = 0;
+	decodeOptions options;
+	size_t arenaLimit = 0; // What the statements of one function may take under the budget
 	Sectioner * worker;
+	StringTable names; // Every name handed to a function lives here
 	std::map<int, Function> funcs;
+	std::vector<globalDef> globals;
+	std::vector<elementSegment> elements;
+	DataSegments data;
+	IndirectTable indirect;
+	BodyIndex bodies;
+	std::shared_ptr<const TypeTable> typeTable; // Read-only once built, shared by every function.
 };
 
 #endif // MEDIATOR_H
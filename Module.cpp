@@ -0,0 +1,76 @@
+#include "Module.h"
+#include "Symbolizer.h"
+
+///	<summary>Reads a module that is already in memory. The bytes are copied, so the
+///	caller's buffer can go away afterwards.</summary>
+Module::Module(const byte* data, size_t size, decodeOptions options)
+	: reader(std::make_unique<Sectioner>(data, size))
+{
+	mediator = std::make_unique<Mediator>(reader.get(), false, options);
+}
+
+///	<summary>Reads a module file. Sections are read from the file as they are needed.</summary>
+Module::Module(std::string filename, decodeOptions options)
+	: reader(std::make_unique<Sectioner>(filename))
+{
+	mediator = std::make_unique<Mediator>(reader.get(), false, options);
+}
+
+///	<summary>Number of functions in the module, imported ones included.</summary>
+int Module::functionCount() const
+{
+	return mediator->getFunctionCount();
+}
+
+///	<summary>A function by index, for its name, signature, locals and body. It is only
+///	decoded while render() works on it.</summary>
+const Function& Module::function(int index) const
+{
+	return mediator->getFunction(index);
+}
+
+const Sectioner& Module::getSections() const
+{
+	return *reader;
+}
+
+///	<summary>The pieces underneath, for the tools that work on them directly.</summary>
+Mediator& Module::getMediator()
+{
+	return *mediator;
+}
+
+///	<summary>Tells an emitter the names, memory and tables of this module. Has to happen
+///	once before render() is used with it.</summary>
+void Module::prepare(Emitter& emitter) const
+{
+	emitter.setFunctionNames(mediator->getFunctionNames());
+	emitter.setDataSegments(&mediator->getDataSegments());
+	emitter.setIndirectTable(&mediator->getIndirectTable());
+}
+
+///	<summary>Decodes one defined function and appends its text to 'out'. Imported
+///	functions have no body and add nothing.</summary>
+void Module::render(int index, const Emitter& emitter, std::string& out)
+{
+	const Function& func = mediator->getFunction(index);
+	if (func.isImported)
+		return;
+
+	mediator->decodeFunction(index);
+	emitter.emit(func, index, out);
+	mediator->releaseFunction(index);
+}
+
+///	<summary>Renders every defined function to 'out' in index order.</summary>
+void Module::renderAll(Emitter& emitter, std::ostream& out, unsigned threads)
+{
+	mediator->emitFunctions(emitter, out, threads);
+}
+
+///	<summary>The function and instruction at each offset into the module, in the order
+///	the offsets were given.</summary>
+std::vector<std::string> Module::symbolize(const std::vector<uint32_t>& offsets)
+{
+	return Symbolizer::resolve(*mediator, offsets);
+}
@@ -0,0 +1,43 @@
+#ifndef MODULE_H
+#define MODULE_H
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Sectioner.h"
+#include "Mediator.h"
+#include "Emitter.h"
+
+///	<summary>
+///	The decompiler as a library: one module, sectioned and read, held in memory for
+///	as long as the caller likes. Nothing here writes to stdout; every piece of
+///	output goes to a buffer or stream the caller hands over.<br>
+///	Functions are decoded when they are rendered and let go of afterwards under a
+///	memory budget (see decodeOptions). Symbolizing only skims bodies, so a module
+///	kept around to answer offset queries costs its bytes and the body index.<br>
+///	Rendering different functions, and symbolizing, can happen from any number of
+///	threads at once. Rendering the same function from two threads can't.
+///	</summary>
+class Module
+{
+public:
+	Module(const byte* data, size_t size, decodeOptions options = decodeOptions{});
+	Module(std::string filename, decodeOptions options = decodeOptions{});
+
+	int functionCount() const;
+	const Function& function(int index) const;
+	const Sectioner& getSections() const;
+	Mediator& getMediator();
+
+	void prepare(Emitter& emitter) const;
+	void render(int index, const Emitter& emitter, std::string& out);
+	void renderAll(Emitter& emitter, std::ostream& out, unsigned threads = 1);
+	std::vector<std::string> symbolize(const std::vector<uint32_t>& offsets);
+
+private:
+	std::unique_ptr<Sectioner> reader; // The mediator points at it, so it stays put on the heap
+	std::unique_ptr<Mediator> mediator;
+};
+
+#endif // MODULE_H
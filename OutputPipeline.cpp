@@ -0,0 +1,88 @@
+#include "OutputPipeline.h"
+
+// Batches stop growing past this many bytes, so output keeps flowing while a large run of chunks is ready.
+static const size_t batchLimit = 1 << 20;
+
+///	<summary>Sets up 'count' positions and starts the writer. At most 'window' positions
+///	past the last written one can be rendered at a time.</summary>
+OutputPipeline::OutputPipeline(std::ostream& out, size_t count, size_t window)
+	: out(out), chunks(count), ready(count, false), window(window == 0 ? 1 : window)
+{
+	writer = std::thread(&OutputPipeline::writeLoop, this);
+}
+
+OutputPipeline::~OutputPipeline()
+{
+	abort();
+}
+
+///	<summary>Blocks until 'position' is close enough to the writer to be rendered. The
+///	first position that hasn't been written never waits, so the pipeline always moves.</summary>
+void OutputPipeline::waitForRoom(size_t position)
+{
+	std::unique_lock<std::mutex> hold(lock);
+	roomFreed.wait(hold, [&] { return stopped || position < written + window; });
+}
+
+///	<summary>Hands over the rendered text of a position.</summary>
+void OutputPipeline::submit(size_t position, std::string chunk)
+{
+	{
+		std::lock_guard<std::mutex> hold(lock);
+		chunks[position] = std::move(chunk);
+		ready[position] = true;
+	}
+	chunkReady.notify_one();
+}
+
+///	<summary>Stops the writer without waiting for the remaining positions. Used when a
+///	worker fails, so nothing is left waiting on a chunk that will never come.</summary>
+void OutputPipeline::abort()
+{
+	{
+		std::lock_guard<std::mutex> hold(lock);
+		stopped = true;
+	}
+	chunkReady.notify_all();
+	roomFreed.notify_all();
+	if (writer.joinable())
+		writer.join();
+}
+
+///	<summary>Waits for every position to be written.</summary>
+void OutputPipeline::finish()
+{
+	if (writer.joinable())
+		writer.join();
+}
+
+void OutputPipeline::writeLoop()
+{
+	std::vector<std::string> batch;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> hold(lock);
+			chunkReady.wait(hold, [&] { return stopped || written == chunks.size() || ready[written]; });
+			if (written == chunks.size() || (stopped && !ready[written]))
+				return;
+
+			// Take everything that is ready in order
+			size_t bytes = 0;
+			while (written < chunks.size() && ready[written] && bytes < batchLimit)
+			{
+				bytes += chunks[written].size();
+				batch.push_back(std::move(chunks[written]));
+				chunks[written] = std::string();
+				written++;
+			}
+		}
+		roomFreed.notify_all();
+
+		// The stream is only touched by this thread, so the batch is written without the lock
+		for (const auto& chunk : batch)
+			out.write(chunk.data(), chunk.size());
+		out.flush();
+		batch.clear();
+	}
+}
@@ -0,0 +1,49 @@
+#ifndef OUTPUTPIPELINE_H
+#define OUTPUTPIPELINE_H
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+///	<summary>
+///	Puts rendered chunks back in order while they are being produced. Workers
+///	render whatever position they were handed into their own string and submit
+///	it; a writer thread writes chunks strictly by position, so the output is the
+///	same byte for byte no matter how many workers there are or which finishes first.<br>
+///	The writer takes every chunk that is ready in one go and writes them as a
+///	batch with a single flush, so a burst of small functions costs one write to
+///	the stream rather than one per function. Written chunks are released straight
+///	away, and workers wait before running too far ahead of the writer, which keeps
+///	the memory held by the pipeline bounded.
+///	</summary>
+class OutputPipeline
+{
+public:
+	OutputPipeline(std::ostream& out, size_t count, size_t window);
+	~OutputPipeline();
+
+	void waitForRoom(size_t position);
+	void submit(size_t position, std::string chunk);
+	void abort();
+	void finish();
+
+private:
+	void writeLoop();
+
+	std::ostream& out;
+	std::vector<std::string> chunks;
+	std::vector<bool> ready;
+	size_t window;
+	size_t written = 0; // Every position below this has been written
+	bool stopped = false;
+
+	std::mutex lock;
+	std::condition_variable chunkReady;
+	std::condition_variable roomFreed;
+	std::thread writer;
+};
+
+#endif // OUTPUTPIPELINE_H
@@ -0,0 +1,235 @@
+#include "Profiler.h"
+#include "Skimmer.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+///	<summary>Scans every defined function. The profiles come back in function order.</summary>
+std::vector<functionProfile> Profiler::profile(Mediator& module, unsigned threads)
+{
+	const BodyIndex& bodies = module.getBodyIndex();
+	std::vector<functionProfile> profiles(bodies.size());
+
+	std::atomic<size_t> nextBody{ 0 };
+	auto work = [&]()
+	{
+		for (size_t i = nextBody++; i < profiles.size(); i = nextBody++)
+		{
+			const int index = module.getBodyFunction((int)i);
+			const Function& func = module.getFunction(index);
+			functionProfile& result = profiles[i];
+			result = scan(func.getBody());
+			result.index = index;
+			result.name = func.getTitle();
+			result.bytes = bodies.at(i).size;
+			if (result.error.empty())
+				result.error = func.getError();
+		}
+	};
+
+	if (threads <= 1)
+		work();
+	else
+	{
+		std::vector<std::thread> workers;
+		for (unsigned i = 0; i < threads; ++i)
+			workers.emplace_back(work);
+		for (auto& worker : workers)
+			worker.join();
+	}
+
+	return profiles;
+}
+
+///	<summary>Skims the instructions of a body. An instruction that can't be read ends
+///	the scan, and what was counted up to there is kept.</summary>
+functionProfile Profiler::scan(const std::vector<byte>& code)
+{
+	functionProfile result;
+	uint32_t plain[256] = {};
+	std::vector<std::pair<uint32_t, uint32_t>> prefixed;
+
+	uint32_t depth = 0;
+	Skimmer skimmer(code);
+	skimmedIns next;
+	while (skimmer.next(next))
+	{
+		const uint32_t op = next.key;
+		result.instructions++;
+		if (op > 0xff)
+		{
+			auto found = std::find_if(prefixed.begin(), prefixed.end(), [&](const auto& entry) { return entry.first == op; });
+			if (found != prefixed.end())
+				found->second++;
+			else
+				prefixed.emplace_back(op, 1);
+		}
+		else
+			plain[op]++;
+
+		if (op >= 0x02 && op <= 0x04)
+			result.maxDepth = std::max(result.maxDepth, ++depth);
+		else if (op == 0x0b && depth > 0)
+			depth--;
+		else if (op == 0x10 || op == 0x11)
+			result.calls++;
+
+		if (opcodes::accessOf(*next.ins).width != 0)
+			result.memoryOps++;
+	}
+	if (skimmer.failed())
+		result.error = "Unknown instruction or bad immediate at +" + std::to_string(skimmer.position());
+
+	for (uint32_t op = 0; op < 256; ++op)
+	{
+		if (plain[op] != 0)
+			result.histogram.emplace_back(op, plain[op]);
+	}
+	std::sort(prefixed.begin(), prefixed.end());
+	result.histogram.insert(result.histogram.end(), prefixed.begin(), prefixed.end());
+	return result;
+}
+
+///	<summary>Orders profiles with the largest first, or by function index.</summary>
+void Profiler::sort(std::vector<functionProfile>& profiles, sortKey key)
+{
+	auto metric = [key](const functionProfile& profile) -> uint64_t
+	{
+		switch (key)
+		{
+		case bySize: return profile.bytes;
+		case byInstructions: return profile.instructions;
+		case byDepth: return profile.maxDepth;
+		case byCalls: return profile.calls;
+		case byMemory: return profile.memoryOps;
+		default: return 0;
+		}
+	};
+
+	std::stable_sort(profiles.begin(), profiles.end(), [&](const functionProfile& a, const functionProfile& b)
+	{
+		if (key == byIndex)
+			return a.index < b.index;
+		return metric(a) > metric(b);
+	});
+}
+
+///	<summary>Reads the name of a sort key: index, size, instructions, depth, calls or memory.</summary>
+bool Profiler::parseSortKey(const std::string& text, sortKey& key)
+{
+	static const std::pair<const char*, sortKey> keys[] = { { "index", byIndex }, { "size", bySize },
+		{ "instructions", byInstructions }, { "depth", byDepth }, { "calls", byCalls }, { "memory", byMemory } };
+	for (const auto& entry : keys)
+	{
+		if (text == entry.first)
+		{
+			key = entry.second;
+			return true;
+		}
+	}
+	return false;
+}
+
+///	<summary>One row per function. The opcode column lists "name:count" pairs, most used first.</summary>
+void Profiler::writeCsv(const std::vector<functionProfile>& profiles, std::ostream& out)
+{
+	std::string text = "index,name,bytes,instructions,max_depth,calls,memory_ops,opcodes,error\n";
+	auto quoted = [](const std::string& field)
+	{
+		if (field.find_first_of(",\"\n") == std::string::npos)
+			return field;
+
+		std::string result = "\"";
+		for (char c : field)
+			result += c == '"' ? std::string("\"\"") : std::string(1, c);
+		return result + '"';
+	};
+
+	for (const auto& profile : profiles)
+	{
+		std::string opcodes;
+		for (const auto& entry : byCount(profile))
+			opcodes += (opcodes.empty() ? "" : " ") + opcodeName(entry.first) + ':' + std::to_string(entry.second);
+
+		text += std::to_string(profile.index) + ',' + quoted(functionName(profile)) + ',' + std::to_string(profile.bytes) + ','
+			+ std::to_string(profile.instructions) + ',' + std::to_string(profile.maxDepth) + ','
+			+ std::to_string(profile.calls) + ',' + std::to_string(profile.memoryOps) + ','
+			+ opcodes + ',' + quoted(profile.error) + '\n';
+	}
+	out << text;
+}
+
+///	<summary>An array with an object per function. The opcodes are an object of counts, most used first.</summary>
+void Profiler::writeJson(const std::vector<functionProfile>& profiles, std::ostream& out)
+{
+	auto quoted = [](const std::string& field)
+	{
+		std::string result = "\"";
+		for (char c : field)
+		{
+			if (c == '"' || c == '\\')
+				result += '\\';
+			if ((unsigned char)c < 0x20)
+			{
+				static const char digits[] = "0123456789abcdef";
+				result += "\\u00";
+				result += digits[(c >> 4) & 0xf];
+				result += digits[c & 0xf];
+				continue;
+			}
+			result += c;
+		}
+		return result + '"';
+	};
+
+	std::string text = "[\n";
+	for (size_t i = 0; i < profiles.size(); ++i)
+	{
+		const functionProfile& profile = profiles[i];
+		text += "  {\"index\": " + std::to_string(profile.index) + ", \"name\": " + quoted(functionName(profile))
+			+ ", \"bytes\": " + std::to_string(profile.bytes) + ", \"instructions\": " + std::to_string(profile.instructions)
+			+ ", \"max_depth\": " + std::to_string(profile.maxDepth) + ", \"calls\": " + std::to_string(profile.calls)
+			+ ", \"memory_ops\": " + std::to_string(profile.memoryOps) + ", \"opcodes\": {";
+
+		bool first = true;
+		for (const auto& entry : byCount(profile))
+		{
+			text += (first ? "" : ", ") + quoted(opcodeName(entry.first)) + ": " + std::to_string(entry.second);
+			first = false;
+		}
+		text += '}';
+		if (!profile.error.empty())
+			text += ", \"error\": " + quoted(profile.error);
+		text += i + 1 < profiles.size() ? "},\n" : "}\n";
+	}
+	text += "]\n";
+	out << text;
+}
+
+///	<summary>The printed name of an opcode key.</summary>
+std::string Profiler::opcodeName(uint32_t key)
+{
+	if (key > 0xff)
+		return opcodes::find((byte)(key >> 24), key & 0xffffff).symbol;
+
+	// A few opcodes share a name with another, so those are told apart
+	if (key == 0x1c)
+		return "select_t";
+	return opcodes::find((byte)key).symbol;
+}
+
+std::string Profiler::functionName(const functionProfile& profile)
+{
+	if (!profile.name.empty())
+		return std::string(profile.name);
+
+	return "func_" + std::to_string(profile.index);
+}
+
+///	<summary>The histogram ordered by count, most used first.</summary>
+std::vector<std::pair<uint32_t, uint32_t>> Profiler::byCount(const functionProfile& profile)
+{
+	auto entries = profile.histogram;
+	std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+	return entries;
+}
@@ -0,0 +1,49 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Mediator.h"
+
+///	<summary>What one function body is made of.</summary>
+struct functionProfile
+{
+	int index = 0;
+	std::string_view name{};
+	uint32_t bytes = 0; // The whole body, locals declaration included
+	uint32_t instructions = 0;
+	uint32_t maxDepth = 0; // Deepest nesting of blocks, loops and ifs
+	uint32_t calls = 0; // Direct and indirect
+	uint32_t memoryOps = 0; // Loads and stores
+	std::vector<std::pair<uint32_t, uint32_t>> histogram{}; // Opcode key -> count. Prefixed opcodes are prefix << 24 | sub-opcode.
+	std::string error{}; // Set when the scan hit something it couldn't size
+};
+
+///	<summary>
+///	Size and instruction mix of every function in a module, for finding code size
+///	and hot path outliers.<br>
+///	Bodies are only skimmed and no statements are built, so this is far cheaper
+///	than decoding. Functions are independent, so the scan is spread over threads.
+///	</summary>
+class Profiler
+{
+public:
+	enum sortKey { byIndex, bySize, byInstructions, byDepth, byCalls, byMemory };
+
+	static std::vector<functionProfile> profile(Mediator& module, unsigned threads = 1);
+	static functionProfile scan(const std::vector<byte>& code);
+	static void sort(std::vector<functionProfile>& profiles, sortKey key);
+	static bool parseSortKey(const std::string& text, sortKey& key);
+	static void writeCsv(const std::vector<functionProfile>& profiles, std::ostream& out);
+	static void writeJson(const std::vector<functionProfile>& profiles, std::ostream& out);
+
+private:
+	static std::string opcodeName(uint32_t key);
+	static std::string functionName(const functionProfile& profile);
+	static std::vector<std::pair<uint32_t, uint32_t>> byCount(const functionProfile& profile);
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,120 @@
+#include "PseudoEmitter.h"
+
+const char* PseudoEmitter::name() const
+{
+	return "pseudo";
+}
+
+///	<summary>The signature, the locals and a summary of the memory traffic.</summary>
+void PseudoEmitter::beginFunction(emitState& state, std::string& out) const
+{
+	const Function& func = state.func;
+
+	// Start with the function signature
+	const signature& sig = func.getSignature();
+	out += typeName(sig.output.type);
+	out += ' ';
+
+	// Add the function name
+	out += func.getTitle();
+	out += '(';
+
+	std::string inputs;
+	// Add the input definitions
+	for (const auto& func_input : sig.inputs)
+	{
+		inputs += typeName(func_input.type);
+		inputs += ' ';
+		inputs += func_input.name;
+		inputs += ", ";
+	}
+
+	// Remove the trailing comma and space
+	inputs = inputs.substr(0, inputs.size() - 2);
+	if (inputs.empty())
+		inputs = "void";
+	out += inputs;
+	out += ")\n";
+
+	// Declare the locals, one line per run so huge declarations stay short.
+	for (const auto& run : func.getLocals())
+	{
+		if (run.count == 0)
+			continue;
+
+		const std::string prefix = std::string("__") + typeName(run.type) + "_local_";
+		indent(1, out);
+		out += std::string(typeName(run.type)) + ' ' + prefix + std::to_string(run.first);
+		if (run.count > 1)
+			out += " ... " + prefix + std::to_string(run.first + run.count - 1);
+		out += '\n';
+	}
+
+	// Summarise the memory traffic, which makes memory bound functions easy to spot.
+	const memorySummary& memory = func.getMemorySummary();
+	if (memory.totalLoads() != 0 || memory.totalStores() != 0)
+	{
+		auto widths = [](const uint32_t* counts)
+		{
+			std::string listed;
+			for (int bucket = 0; bucket < memorySummary::buckets; ++bucket)
+			{
+				if (counts[bucket] == 0)
+					continue;
+				if (!listed.empty())
+					listed += ", ";
+				listed += std::to_string(1 << bucket) + "B x" + std::to_string(counts[bucket]);
+			}
+			return listed.empty() ? std::string() : " (" + listed + ")";
+		};
+
+		indent(1, out);
+		out += "// memory: " + std::to_string(memory.totalLoads()) + " loads" + widths(memory.loads)
+			+ ", " + std::to_string(memory.totalStores()) + " stores" + widths(memory.stores) + '\n';
+	}
+}
+
+///	<summary>Put the final end in the function</summary>
+void PseudoEmitter::endFunction(emitState& /*state*/, std::string& out) const
+{
+	out += "end\n";
+}
+
+void PseudoEmitter::openBlock(const statement* node, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	out += printStatement(node) + '\n';
+}
+
+///	<summary>Elses sit at the level of the if they split. The value the first branch
+///	ends with was already written as the last line of it.</summary>
+void PseudoEmitter::elseBlock(const statement* node, emitState& state, std::string& out) const
+{
+	indent(state.depth() - 1, out);
+	out += std::string(node->operation.op.symbol) + '\n';
+}
+
+void PseudoEmitter::closeBlock(const statement* /*opener*/, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	out += "end\n";
+}
+
+///	<summary>The value a block ends with is written last in it, like the binary has it.</summary>
+void PseudoEmitter::blockValue(const statement* value, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	out += printStatement(value) + '\n';
+}
+
+///	<summary>One statement per line. What the line refers to goes in a comment after it.</summary>
+void PseudoEmitter::line(const statement* node, const statement* /*next*/, emitState& state, std::string& out) const
+{
+	indent(state.depth(), out);
+	out += printStatement(node);
+
+	const std::string comment = notes(node);
+	if (!comment.empty())
+		out += " // " + comment;
+	out += '\n';
+}
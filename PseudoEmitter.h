@@ -0,0 +1,22 @@
+#ifndef PSEUDOEMITTER_H
+#define PSEUDOEMITTER_H
+#include "Emitter.h"
+
+///	<summary>The decompiler's own format: the instructions keep their names and
+///	operands are nested in brackets. This is what gets printed by default.</summary>
+class PseudoEmitter : public Emitter
+{
+public:
+	const char* name() const override;
+
+protected:
+	void beginFunction(emitState& state, std::string& out) const override;
+	void endFunction(emitState& state, std::string& out) const override;
+	void openBlock(const statement* node, emitState& state, std::string& out) const override;
+	void elseBlock(const statement* node, emitState& state, std::string& out) const override;
+	void closeBlock(const statement* opener, emitState& state, std::string& out) const override;
+	void blockValue(const statement* value, emitState& state, std::string& out) const override;
+	void line(const statement* node, const statement* next, emitState& state, std::string& out) const override;
+};
+
+#endif // PSEUDOEMITTER_H
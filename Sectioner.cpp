@@ -1,4 +1,5 @@
 #include "Sectioner.h"
+#include <algorithm>
 
 ///	<summary>Returns the size of a file in bytes.</summary>
 int getFileSize(const std::string& cs)
@@ -18,7 +19,8 @@ int getFileSize(const std::string& cs)
 Sectioner::Sectioner(std::string& filename)
 {
 	this->filename = filename;
-	sectionListings.resize(12);
+	for (int& entry : firstOfId)
+		entry = -1;
 
 	// Grab the file size while we're here
 	fileSize = getFileSize(filename);
@@ -27,6 +29,21 @@ Sectioner::Sectioner(std::string& filename)
 	sectionBytes();
 }
 
+///	<summary>Sections a module that is already in memory.</summary>
+Sectioner::Sectioner(const byte* data, size_t size)
+	: buffer(data, data + size), inMemory(true)
+{
+	for (int& entry : firstOfId)
+		entry = -1;
+
+	// Offsets are kept as ints, like they are for files
+	if (size > INT32_MAX)
+		throw std::exception("The module is too large.");
+	fileSize = (int)size;
+
+	sectionBytes();
+}
+
 /// <Summary> Read the entire file into a vector detailing the byte values </Summary>
 void Sectioner::readFromFile(std::string& filename)
 {
@@ -36,30 +53,102 @@ void Sectioner::readFromFile(std::string& filename)
 		//std::istreambuf_iterator<char>());
 }
 
-///	<summary>Return a vector with the byte string in it from the section listings. Valid ID's range from 0 -> 11</summary>
-std::vector<byte> Sectioner::getSection(int id)
+///	<summary>Reads the contents of a section from the file. Valid ID's range from 0 -> 12, and
+///	a section that isn't there gives an empty vector. For id 0 this is the first custom section.</summary>
+std::vector<byte> Sectioner::getSection(int id) const
+{
+	if (id < 0 || id >= sectionCount)
+		throw std::exception("Bad parameter for getSection.");
+
+	const sectionEntry* entry = findSection(id);
+	if (entry == nullptr)
+		return std::vector<byte>();
+
+	return getSection(*entry);
+}
+
+///	<summary>Reads the contents of a section of the directory from the file.</summary>
+std::vector<byte> Sectioner::getSection(const sectionEntry& entry) const
+{
+	if (entry.length == 0)
+		return std::vector<byte>();
+
+	return readNBytesFromFile(entry.length, entry.offset);
+}
+
+///	<summary>The contents of the first custom section with a name, after the name.
+///	Empty if there isn't one.</summary>
+std::vector<byte> Sectioner::getCustomSection(const std::string& name) const
+{
+	for (const auto& entry : directory)
+	{
+		if (entry.id != 0 || entry.name != name)
+			continue;
+
+		std::vector<byte> contents = getSection(entry);
+		int nameLength;
+		const int skip = getNextu32(contents, 0, nameLength) + nameLength;
+		contents.erase(contents.begin(), contents.begin() + skip);
+		return contents;
+	}
+
+	return std::vector<byte>();
+}
+
+///	<summary>The first section with an id, or nullptr if the module doesn't have one.</summary>
+const sectionEntry* Sectioner::findSection(int id) const
+{
+	if (id < 0 || id >= sectionCount || firstOfId[id] < 0)
+		return nullptr;
+
+	return &directory[firstOfId[id]];
+}
+
+///	<summary>Every section of the file, in the order they appear.</summary>
+const std::vector<sectionEntry>& Sectioner::getDirectory() const
+{
+	return directory;
+}
+
+///	<summary>Writes the directory as a table: id, file offset and length of the contents,
+///	and the name of custom sections.</summary>
+void Sectioner::printDirectory(std::ostream& out) const
 {
-	if (id >= 0 && id < 12)
-		return sectionListings[id];
+	static const char* names[sectionCount] = { "custom", "type", "import", "function", "table", "memory",
+		"global", "export", "start", "element", "code", "data", "datacount" };
 
-	throw std::exception("Bad parameter for getSection.");
+	out << " id  section        offset      length" << std::endl;
+	for (const auto& entry : directory)
+	{
+		out << std::setw(3) << (int)entry.id << "  " << std::left << std::setw(10) << names[entry.id] << std::right
+			<< std::setw(11) << entry.offset << std::setw(12) << entry.length;
+		if (entry.id == 0)
+			out << "  \"" << entry.name << '"';
+		out << std::endl;
+	}
 }
 
 /// <Summary> Function that reads n bytes from the offset specified from the target file. </Summary>
 void Sectioner::readNBytesFromFile(int n_bytes, int fileOffset, char* out) const
 {
+	if (inMemory)
+	{
+		if (n_bytes < 0 || fileOffset < 0 || n_bytes > fileSize - fileOffset)
+			throw std::exception("Read past the end of the module.");
+		std::copy(buffer.begin() + fileOffset, buffer.begin() + fileOffset + n_bytes, out);
+		return;
+	}
+
 	std::ifstream is(filename, std::ios::binary);
 
 	is.seekg(fileOffset);
 
 	is.read(out, n_bytes);
 
-	if(!is) // File fails somehow.
+	if(!is) // File fails somehow. Leave it to the caller whether that ends the run.
 	{
-		std::cout << "Error in reading from file: " << filename << std::endl;
-		std::cout << "The program will now close." << std::endl;
-		is.close();
-		exit(1);
+		std::string ex = "Error in reading from file: " + filename;
+		throw std::exception(ex.c_str());
 	}
 
 	is.close();
@@ -86,27 +175,36 @@ std::vector<byte> Sectioner::readNBytesFromFile(int n_bytes, int fileOffset) con
 	return temp;
 }
 
+///	<summary>The version field of the module header.</summary>
+uint32_t Sectioner::getVersion() const
+{
+	return version;
+}
+
 ///	<summary>A helper function to print out some formatted info about
 ///	the sections that the sectioner has determined. 
 ///	</summary>
-void Sectioner::sectionReport()
+void Sectioner::sectionReport(std::ostream& out) const
 {
-	// Iterate through each section in the section listings
-	for(int i = 0; i < sectionListings.size(); ++i)
+	// Iterate through each known section. The data count section is newer than the rest
+	// and only gets a line when the module has one.
+	for(int i = 0; i < sectionCount; ++i)
 	{
-		if(!sectionListings[i].empty())
+		const sectionEntry* entry = findSection(i);
+		if(entry != nullptr && entry->length != 0)
 		{
-			std::cout << "Section " << std::setw(2) << i << " present.";
-			std::cout << std::setw(20) << sectionListings[i].size() << " Bytes" << std::endl;
+			out << "Section " << std::setw(2) << i << " present.";
+			out << std::setw(20) << entry->length << " Bytes" << std::endl;
 		}
-		else
+		else if (i < 12)
 		{
-			std::cout << "Section " << std::setw(2) << i << " is not present." << std::endl;
+			out << "Section " << std::setw(2) << i << " is not present." << std::endl;
 		}
 	}
 }
 
-/// <summary>Breaks the list of bytes into each section. </summary>
+/// <summary>Builds the section directory. Only the id and size of each section are read;
+/// the size is a LEB of up to 5 bytes, and the contents follow it directly.</summary>
 void Sectioner::sectionBytes()
 {
 	// Start iterating through the bytes
@@ -115,11 +213,10 @@ void Sectioner::sectionBytes()
 	// to the next one.
 
 	int fileOff = 0;
-	int sectionID;
-	int sectionSize;
-	char* size = new char[4]; // Char pointer for the sizes.
 
 	// Read the first 8 bytes to verify the magic signature.
+	if (fileSize < 8)
+		throw std::exception("The file is too small to be a module.");
 	std::vector<byte> out = readNBytesFromFile(8, 0);
 	byte magic[] = { 0, 0x61, 0x73, 0x6d }; // \0asm
 	for (int i = 0; i < 4; ++i)
@@ -129,42 +226,50 @@ void Sectioner::sectionBytes()
 			throw std::exception("The magic string was malformed.");
 	}
 
-	// Write the version of the wasm to the console
-	std::cout << "WASM Version: ";
-	for (int i = 4; i < 8; ++i)
-	{
-		if (out[i] != '\0')
-			std::cout << (int)out[i];
-	}
-	std::cout << std::endl;
+	// Keep the version of the wasm for whoever wants to show it
+	version = out[4] | (out[5] << 8) | (out[6] << 16) | ((uint32_t)out[7] << 24);
 
 	// Move the offset to the start of the actual data.
 	fileOff += 8;
 
-	// Now, loop over the other sections to extract their contents.
+	// Now, loop over the other sections to find where their contents are.
 	while (fileOff < fileSize)
 	{
-		// Grab the section id
-		out = readNBytesFromFile(1, fileOff);
-		fileOff += 1;
-		sectionID = out.front();
-
-		// Next 4 bytes are the size of the section
-		readNBytesFromFile(4, fileOff, size);
-		fileOff += 4;
-		sectionSize = u_decLEB32(size);
-
-		// Get the contents of the section
-		out = readNBytesFromFile(sectionSize, fileOff + 1); // +1 because SpiderMonkey is dumb.
-		fileOff += sectionSize + 1;
-
-		// Put the bytes into the section vector
-		sectionListings[sectionID] = out;	
-	}
+		// The id and the size LEB come together, in at most 6 bytes
+		out = readNBytesFromFile(std::min(6, fileSize - fileOff), fileOff);
+		sectionEntry entry;
+		entry.id = out.front();
+		if (entry.id >= sectionCount)
+			throw std::exception("Unknown section id.");
+
+		int sectionSize;
+		const int sizeLength = getNextu32(out, 1, sectionSize);
+		if (sizeLength == 0 || out[sizeLength] > 0x7f)
+			throw std::exception("Malformed section size.");
 
-	delete[] size;
+		fileOff += 1 + sizeLength;
+		if ((uint32_t)sectionSize > (uint32_t)(fileSize - fileOff))
+			throw std::exception("Section runs past the end of the file.");
 
-	std::cout << "Done sectioning file." << std::endl << std::endl;
-	sectionReport();
-	std::cout << std::endl;
+		entry.offset = fileOff;
+		entry.length = sectionSize;
+		fileOff += sectionSize;
+
+		// Custom sections start with their name
+		if (entry.id == 0 && sectionSize != 0)
+		{
+			std::vector<byte> head = readNBytesFromFile(std::min(5, sectionSize), entry.offset);
+			int nameLength;
+			const int lengthSize = getNextu32(head, 0, nameLength);
+			if (nameLength < 0 || lengthSize + nameLength > sectionSize)
+				throw std::exception("Malformed custom section name.");
+
+			std::vector<byte> name = readNBytesFromFile(nameLength, entry.offset + lengthSize);
+			entry.name.assign(name.begin(), name.end());
+		}
+
+		if (firstOfId[entry.id] < 0)
+			firstOfId[entry.id] = (int)directory.size();
+		directory.push_back(std::move(entry));
+	}
 }
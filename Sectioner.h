@@ -9,23 +9,56 @@
 
 typedef unsigned char byte;
 
+///	<summary>Where a section sits in the file. 'offset' and 'length' cover the contents
+///	after the size, so a custom section's name is part of them.</summary>
+struct sectionEntry
+{
+	byte id = 0;
+	std::string name{}; // Only custom sections (id 0) have one
+	uint32_t offset = 0;
+	uint32_t length = 0;
+};
+
+///	<summary>
+///	Finds the sections of a module file. Only the section headers are read up front,
+///	into a directory of where each section is; the contents are read from the file
+///	when somebody asks for them, so a section that is never used is never loaded.<br>
+///	Section ids 0 to 12 are known. A module can have any number of custom sections,
+///	which are told apart by name.<br>
+///	A module already in memory can be sectioned the same way, with the bytes copied
+///	in. Nothing is printed while sectioning; sectionReport writes the summary to
+///	whatever stream the caller picks.
+///	</summary>
 class Sectioner
 {
 public:
 	Sectioner(std::string& filename);
+	Sectioner(const byte* data, size_t size);
 	void readFromFile(std::string& filename);
-	std::vector<byte> getSection(int id);
+	std::vector<byte> getSection(int id) const;
+	std::vector<byte> getSection(const sectionEntry& entry) const;
+	std::vector<byte> getCustomSection(const std::string& name) const;
+	const sectionEntry* findSection(int id) const;
+	const std::vector<sectionEntry>& getDirectory() const;
+	void printDirectory(std::ostream& out) const;
+	void sectionReport(std::ostream& out) const;
+	uint32_t getVersion() const;
+
+	static const int sectionCount = 13; // Ids 0 to 12
 
 private:
-	std::vector<std::vector<byte>> sectionListings;
+	std::vector<sectionEntry> directory; // In file order
+	int firstOfId[sectionCount]; // Index into the directory, or -1 if the section isn't there
 	//std::vector<byte> rawByteString;
 	std::string filename;
+	std::vector<byte> buffer; // The whole module, when it was handed over in memory
+	bool inMemory = false;
 	int fileSize;
+	uint32_t version = 0;
 
 	bool verifyFile();
 	void readNBytesFromFile(int n_bytes, int fileOffset, char* out) const;
 	std::vector<byte> readNBytesFromFile(int n_bytes, int fileOffset) const;
-	void sectionReport();
 	void sectionBytes();
 };
 
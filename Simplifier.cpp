@@ -0,0 +1,865 @@
+#include "Simplifier.h"
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+static float asFloat(uint64_t bits)
+{
+	uint32_t narrow = (uint32_t)bits;
+	float value;
+	memcpy(&value, &narrow, sizeof(value));
+	return value;
+}
+
+static double asDouble(uint64_t bits)
+{
+	double value;
+	memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+static constant fromFloat(float value)
+{
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return constant{ f32, bits };
+}
+
+static constant fromDouble(double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return constant{ f64, bits };
+}
+
+static constant fromBool(bool value)
+{
+	return constant{ i32, value ? 1u : 0u };
+}
+
+///	<summary>Counts leading zeros of the low 'width' bits.</summary>
+static uint64_t countLeading(uint64_t value, int width)
+{
+	uint64_t count = 0;
+	for (int bit = width - 1; bit >= 0 && !((value >> bit) & 1); --bit)
+		count++;
+	return count;
+}
+
+static uint64_t countTrailing(uint64_t value, int width)
+{
+	uint64_t count = 0;
+	for (int bit = 0; bit < width && !((value >> bit) & 1); ++bit)
+		count++;
+	return count;
+}
+
+static uint64_t countOnes(uint64_t value)
+{
+	uint64_t count = 0;
+	for (; value != 0; value &= value - 1)
+		count++;
+	return count;
+}
+
+///	<summary>Simplifies a function in place. See the class summary for what that covers.</summary>
+void Simplifier::run(Function& func)
+{
+	foldConstants(func);
+	inlineLocals(func);
+}
+
+///	<summary>Collects every statement of a function and puts them in the order their
+///	instructions appear in the body, indexed by offset. Operands always come before
+///	the instruction using them, so this is also an order where constants can bubble
+///	up, and it is the order locals are written and read in.<br>
+///	Gives back nothing if two statements claim the same offset, which only happens
+///	if the function wasn't decoded properly.</summary>
+std::vector<statement*> Simplifier::inOrder(const Function& func)
+{
+	std::vector<statement*> pending(func.statements.begin(), func.statements.end());
+	std::vector<statement*> nodes;
+	int lastOffset = 0;
+	while (!pending.empty())
+	{
+		statement* node = pending.back();
+		pending.pop_back();
+		if (node == nullptr)
+			continue;
+
+		nodes.push_back(node);
+		if (node->offset > lastOffset)
+			lastOffset = node->offset;
+		pending.push_back(node->leftOperand);
+		pending.push_back(node->rightOperand);
+		pending.insert(pending.end(), node->arguments.begin(), node->arguments.end());
+	}
+
+	std::vector<statement*> ordered(lastOffset + 1, nullptr);
+	for (statement* node : nodes)
+	{
+		if (ordered[node->offset] != nullptr)
+			return {};
+		ordered[node->offset] = node;
+	}
+	return ordered;
+}
+
+///	<summary>Folds constant expressions and carries constants written to locals into the
+///	reads that follow them in the same basic block.</summary>
+void Simplifier::foldConstants(Function& func)
+{
+	const std::vector<statement*> ordered = inOrder(func);
+
+	// Constants held by locals, tagged with the basic block they were written in.
+	struct knownLocal
+	{
+		constant value;
+		uint32_t block;
+	};
+	std::unordered_map<uint32_t, knownLocal> known;
+	uint32_t block = 0;
+
+	for (statement* node : ordered)
+	{
+		if (node == nullptr)
+			continue;
+
+		const byte op = node->operation.op.op;
+		if (isBlockBoundary(op))
+		{
+			block++; // Forgets every local at once
+			continue;
+		}
+
+		if (op >= 0x20 && op <= 0x22)
+		{
+			int idx;
+			getNextu32(node->operation.bytes, 0, idx);
+
+			// local_get takes the constant if one was written earlier in this block
+			if (op == 0x20)
+			{
+				auto found = known.find(idx);
+				if (found != known.end() && found->second.block == block)
+					node->operation = makeConstant(found->second.value);
+				continue;
+			}
+
+			// local_set and local_tee either record their constant or forget the old one
+			constant value;
+			if (readConstant(node->leftOperand, value))
+				known[idx] = knownLocal{ value, block };
+			else
+				known.erase(idx);
+			continue;
+		}
+
+		simplifyStatement(node);
+	}
+}
+
+///	<summary>Gives back the value of a constant statement.</summary>
+bool Simplifier::readConstant(const statement* node, constant& value)
+{
+	if (node == nullptr || node->leftOperand != nullptr || node->rightOperand != nullptr)
+		return false;
+
+	const auto& bytes = node->operation.bytes;
+	switch (node->operation.op.op)
+	{
+	case 0x41:
+	case 0x42:
+	{
+		int64_t number;
+		getNexts64(bytes, 0, number);
+		value.type = node->operation.op.op == 0x41 ? i32 : i64;
+		value.bits = value.type == i32 ? (uint32_t)number : (uint64_t)number;
+		return true;
+	}
+	case 0x43:
+	case 0x44:
+	{
+		const size_t width = node->operation.op.op == 0x43 ? 4 : 8;
+		if (bytes.size() < width)
+			return false;
+
+		value.type = width == 4 ? f32 : f64;
+		value.bits = 0;
+		for (size_t i = 0; i < width; ++i)
+			value.bits |= (uint64_t)bytes[i] << (8 * i);
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
+///	<summary>Builds the const instruction for a value, encoded the way the binary would have it.</summary>
+oper Simplifier::makeConstant(const constant& value)
+{
+	oper result;
+	switch (value.type)
+	{
+	case i32:
+	case i64:
+	{
+		const std::vector<byte> encoded = value.type == i32 ? encodeSLEB((int32_t)(uint32_t)value.bits) : encodeSLEB((int64_t)value.bits);
+		result.op = opcodes::find(value.type == i32 ? 0x41 : 0x42);
+		result.bytes.assign(encoded.data(), encoded.size());
+		break;
+	}
+	case f32:
+	case f64:
+	{
+		const int width = value.type == f32 ? 4 : 8;
+		byte raw[8];
+		for (int i = 0; i < width; ++i)
+			raw[i] = (byte)(value.bits >> (8 * i));
+		result.op = opcodes::find(value.type == f32 ? 0x43 : 0x44);
+		result.bytes.assign(raw, width);
+		break;
+	}
+	default:
+		break;
+	}
+	return result;
+}
+
+///	<summary>Folds a statement whose operands are constants, or drops the operation when
+///	one operand makes it do nothing.</summary>
+void Simplifier::simplifyStatement(statement* node)
+{
+	if (!node->arguments.empty() || node->leftOperand == nullptr)
+		return;
+
+	const byte op = node->operation.op.op;
+	constant result;
+
+	// Unary operations only have the left side
+	if (node->rightOperand == nullptr)
+	{
+		constant value;
+		if (readConstant(node->leftOperand, value) && foldUnary(op, value, result))
+		{
+			node->operation = makeConstant(result);
+			node->leftOperand = nullptr;
+		}
+		return;
+	}
+
+	// For binary operations the right side was pushed first, so it's the left hand side of the operation
+	constant lhs, rhs;
+	const bool lhsConstant = readConstant(node->rightOperand, lhs);
+	const bool rhsConstant = readConstant(node->leftOperand, rhs);
+	if (lhsConstant && rhsConstant && foldBinary(op, lhs, rhs, result))
+	{
+		node->operation = makeConstant(result);
+		node->leftOperand = nullptr;
+		node->rightOperand = nullptr;
+		return;
+	}
+
+	// Everything below only applies to integers, where the constant is on one side.
+	const bool wide = (op >= 0x7c && op <= 0x8a);
+	if (!wide && !(op >= 0x6a && op <= 0x78))
+		return;
+
+	const uint64_t ones = wide ? ~(uint64_t)0 : 0xffffffffull;
+	const uint64_t shiftMask = wide ? 63 : 31;
+	const byte base = wide ? 0x7c - 0x6a : 0; // Maps the i64 opcodes onto the i32 ones
+	statement* keep = nullptr;
+
+	switch (op - base)
+	{
+	case 0x6a: // add
+	case 0x72: // or
+	case 0x73: // xor
+		if (rhsConstant && rhs.bits == 0)
+			keep = node->rightOperand;
+		else if (lhsConstant && lhs.bits == 0)
+			keep = node->leftOperand;
+		break;
+	case 0x6b: // sub
+		if (rhsConstant && rhs.bits == 0)
+			keep = node->rightOperand;
+		break;
+	case 0x6c: // mul
+		if (rhsConstant && rhs.bits == 1)
+			keep = node->rightOperand;
+		else if (lhsConstant && lhs.bits == 1)
+			keep = node->leftOperand;
+		break;
+	case 0x71: // and
+		if (rhsConstant && rhs.bits == ones)
+			keep = node->rightOperand;
+		else if (lhsConstant && lhs.bits == ones)
+			keep = node->leftOperand;
+		break;
+	case 0x74: // shl, shown as the multiplication it is
+		if (rhsConstant && (rhs.bits & shiftMask) != 0 && (rhs.bits & shiftMask) < shiftMask)
+		{
+			node->operation.op = opcodes::find(wide ? 0x7e : 0x6c);
+			node->leftOperand->operation = makeConstant(constant{ rhs.type, (uint64_t)1 << (rhs.bits & shiftMask) });
+			return;
+		}
+		[[fallthrough]]; // A zero shift is dropped like the others
+	case 0x75: // shr_s
+	case 0x76: // shr_u
+	case 0x77: // rotl
+	case 0x78: // rotr
+		if (rhsConstant && (rhs.bits & shiftMask) == 0)
+			keep = node->rightOperand;
+		break;
+	default:
+		break;
+	}
+
+	if (keep != nullptr)
+	{
+		const int offset = node->offset;
+		*node = *keep;
+		node->offset = offset;
+	}
+}
+
+///	<summary>Folds the single operand operations. Returns false if it can't be done at compile time.</summary>
+bool Simplifier::foldUnary(byte op, const constant& value, constant& result)
+{
+	const uint32_t a32 = (uint32_t)value.bits;
+	const uint64_t a64 = value.bits;
+
+	switch (op)
+	{
+	case 0x45: if (value.type != i32) return false; result = fromBool(a32 == 0); return true;
+	case 0x50: if (value.type != i64) return false; result = fromBool(a64 == 0); return true;
+	case 0x67: result = constant{ i32, countLeading(a32, 32) }; break;
+	case 0x68: result = constant{ i32, countTrailing(a32, 32) }; break;
+	case 0x69: result = constant{ i32, countOnes(a32) }; break;
+	case 0x79: result = constant{ i64, countLeading(a64, 64) }; break;
+	case 0x7a: result = constant{ i64, countTrailing(a64, 64) }; break;
+	case 0x7b: result = constant{ i64, countOnes(a64) }; break;
+	case 0xa7: result = constant{ i32, a64 & 0xffffffffull }; return value.type == i64;			// i32_wrap_i64
+	case 0xac: result = constant{ i64, (uint64_t)(int64_t)(int32_t)a32 }; return value.type == i32;	// i64_extend_i32_s
+	case 0xad: result = constant{ i64, a32 }; return value.type == i32;								// i64_extend_i32_u
+	case 0xbc: result = constant{ i32, value.bits }; return value.type == f32;	// Reinterprets only change the type
+	case 0xbd: result = constant{ i64, value.bits }; return value.type == f64;
+	case 0xbe: result = constant{ f32, value.bits }; return value.type == i32;
+	case 0xbf: result = constant{ f64, value.bits }; return value.type == i64;
+	case 0xc0: result = constant{ i32, (uint32_t)(int32_t)(int8_t)a32 }; break;
+	case 0xc1: result = constant{ i32, (uint32_t)(int32_t)(int16_t)a32 }; break;
+	case 0xc2: result = constant{ i64, (uint64_t)(int64_t)(int8_t)a64 }; break;
+	case 0xc3: result = constant{ i64, (uint64_t)(int64_t)(int16_t)a64 }; break;
+	case 0xc4: result = constant{ i64, (uint64_t)(int64_t)(int32_t)a64 }; break;
+	case 0x8b: case 0x8c: case 0x8d: case 0x8e: case 0x8f: case 0x90: case 0x91:
+	{
+		if (value.type != f32)
+			return false;
+
+		// abs and neg only touch the sign bit, so they are fine even for NaNs
+		if (op == 0x8b)
+			result = constant{ f32, a32 & 0x7fffffffu };
+		else if (op == 0x8c)
+			result = constant{ f32, a32 ^ 0x80000000u };
+		else
+		{
+			const float a = asFloat(a32);
+			if (std::isnan(a))
+				return false;
+
+			float r = op == 0x8d ? std::ceil(a) : op == 0x8e ? std::floor(a) : op == 0x8f ? std::trunc(a)
+				: op == 0x90 ? std::nearbyint(a) : std::sqrt(a);
+			if (std::isnan(r))
+				return false;
+			result = fromFloat(r);
+		}
+		return true;
+	}
+	case 0x99: case 0x9a: case 0x9b: case 0x9c: case 0x9d: case 0x9e: case 0x9f:
+	{
+		if (value.type != f64)
+			return false;
+
+		if (op == 0x99)
+			result = constant{ f64, a64 & 0x7fffffffffffffffull };
+		else if (op == 0x9a)
+			result = constant{ f64, a64 ^ 0x8000000000000000ull };
+		else
+		{
+			const double a = asDouble(a64);
+			if (std::isnan(a))
+				return false;
+
+			double r = op == 0x9b ? std::ceil(a) : op == 0x9c ? std::floor(a) : op == 0x9d ? std::trunc(a)
+				: op == 0x9e ? std::nearbyint(a) : std::sqrt(a);
+			if (std::isnan(r))
+				return false;
+			result = fromDouble(r);
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+
+	// The integer cases above all expect an operand of the same type as their result
+	return value.type == (op >= 0xc2 || (op >= 0x79 && op <= 0x7b) ? i64 : i32);
+}
+
+///	<summary>Folds the two operand operations. Returns false if it can't be done at compile
+///	time, which includes every operation that would trap.</summary>
+bool Simplifier::foldBinary(byte op, const constant& lhs, const constant& rhs, constant& result)
+{
+	if (lhs.type != rhs.type)
+		return false;
+
+	// i32 comparisons and arithmetic
+	if ((op >= 0x46 && op <= 0x4f) || (op >= 0x6a && op <= 0x78))
+	{
+		if (lhs.type != i32)
+			return false;
+
+		const uint32_t a = (uint32_t)lhs.bits, b = (uint32_t)rhs.bits;
+		const int32_t sa = (int32_t)a, sb = (int32_t)b;
+		const uint32_t k = b & 31;
+		uint32_t r;
+		switch (op)
+		{
+		case 0x46: result = fromBool(a == b); return true;
+		case 0x47: result = fromBool(a != b); return true;
+		case 0x48: result = fromBool(sa < sb); return true;
+		case 0x49: result = fromBool(a < b); return true;
+		case 0x4a: result = fromBool(sa > sb); return true;
+		case 0x4b: result = fromBool(a > b); return true;
+		case 0x4c: result = fromBool(sa <= sb); return true;
+		case 0x4d: result = fromBool(a <= b); return true;
+		case 0x4e: result = fromBool(sa >= sb); return true;
+		case 0x4f: result = fromBool(a >= b); return true;
+		case 0x6a: r = a + b; break;
+		case 0x6b: r = a - b; break;
+		case 0x6c: r = a * b; break;
+		case 0x6d: // div_s traps on zero and on the one overflowing division
+			if (b == 0 || (sa == INT32_MIN && sb == -1))
+				return false;
+			r = (uint32_t)(sa / sb);
+			break;
+		case 0x6e:
+			if (b == 0)
+				return false;
+			r = a / b;
+			break;
+		case 0x6f: // rem_s only traps on zero; INT_MIN % -1 is 0
+			if (b == 0)
+				return false;
+			r = sb == -1 ? 0 : (uint32_t)(sa % sb);
+			break;
+		case 0x70:
+			if (b == 0)
+				return false;
+			r = a % b;
+			break;
+		case 0x71: r = a & b; break;
+		case 0x72: r = a | b; break;
+		case 0x73: r = a ^ b; break;
+		case 0x74: r = a << k; break;
+		case 0x75: r = (uint32_t)(sa >> k); break;
+		case 0x76: r = a >> k; break;
+		case 0x77: r = k == 0 ? a : (a << k) | (a >> (32 - k)); break;
+		default:   r = k == 0 ? a : (a >> k) | (a << (32 - k)); break;
+		}
+		result = constant{ i32, r };
+		return true;
+	}
+
+	// i64 comparisons and arithmetic
+	if ((op >= 0x51 && op <= 0x5a) || (op >= 0x7c && op <= 0x8a))
+	{
+		if (lhs.type != i64)
+			return false;
+
+		const uint64_t a = lhs.bits, b = rhs.bits;
+		const int64_t sa = (int64_t)a, sb = (int64_t)b;
+		const uint64_t k = b & 63;
+		uint64_t r;
+		switch (op)
+		{
+		case 0x51: result = fromBool(a == b); return true;
+		case 0x52: result = fromBool(a != b); return true;
+		case 0x53: result = fromBool(sa < sb); return true;
+		case 0x54: result = fromBool(a < b); return true;
+		case 0x55: result = fromBool(sa > sb); return true;
+		case 0x56: result = fromBool(a > b); return true;
+		case 0x57: result = fromBool(sa <= sb); return true;
+		case 0x58: result = fromBool(a <= b); return true;
+		case 0x59: result = fromBool(sa >= sb); return true;
+		case 0x5a: result = fromBool(a >= b); return true;
+		case 0x7c: r = a + b; break;
+		case 0x7d: r = a - b; break;
+		case 0x7e: r = a * b; break;
+		case 0x7f:
+			if (b == 0 || (sa == INT64_MIN && sb == -1))
+				return false;
+			r = (uint64_t)(sa / sb);
+			break;
+		case 0x80:
+			if (b == 0)
+				return false;
+			r = a / b;
+			break;
+		case 0x81:
+			if (b == 0)
+				return false;
+			r = sb == -1 ? 0 : (uint64_t)(sa % sb);
+			break;
+		case 0x82:
+			if (b == 0)
+				return false;
+			r = a % b;
+			break;
+		case 0x83: r = a & b; break;
+		case 0x84: r = a | b; break;
+		case 0x85: r = a ^ b; break;
+		case 0x86: r = a << k; break;
+		case 0x87: r = (uint64_t)(sa >> k); break;
+		case 0x88: r = a >> k; break;
+		case 0x89: r = k == 0 ? a : (a << k) | (a >> (64 - k)); break;
+		default:   r = k == 0 ? a : (a >> k) | (a << (64 - k)); break;
+		}
+		result = constant{ i64, r };
+		return true;
+	}
+
+	// f32 comparisons and arithmetic. Anything touching a NaN is left for the runtime.
+	if ((op >= 0x5b && op <= 0x60) || (op >= 0x92 && op <= 0x98))
+	{
+		if (lhs.type != f32)
+			return false;
+
+		if (op == 0x98) // copysign is pure bit work
+		{
+			result = constant{ f32, (lhs.bits & 0x7fffffffu) | (rhs.bits & 0x80000000u) };
+			return true;
+		}
+
+		const float a = asFloat(lhs.bits), b = asFloat(rhs.bits);
+		if (std::isnan(a) || std::isnan(b))
+			return false;
+
+		float r;
+		switch (op)
+		{
+		case 0x5b: result = fromBool(a == b); return true;
+		case 0x5c: result = fromBool(a != b); return true;
+		case 0x5d: result = fromBool(a < b); return true;
+		case 0x5e: result = fromBool(a > b); return true;
+		case 0x5f: result = fromBool(a <= b); return true;
+		case 0x60: result = fromBool(a >= b); return true;
+		case 0x92: r = a + b; break;
+		case 0x93: r = a - b; break;
+		case 0x94: r = a * b; break;
+		case 0x95: r = a / b; break;
+		default: // min and max care about the sign of zero, which std::fmin doesn't promise
+			if (a == 0 && b == 0)
+				return false;
+			r = op == 0x96 ? std::fmin(a, b) : std::fmax(a, b);
+			break;
+		}
+		if (std::isnan(r))
+			return false;
+		result = fromFloat(r);
+		return true;
+	}
+
+	// f64 comparisons and arithmetic
+	if ((op >= 0x61 && op <= 0x66) || (op >= 0xa0 && op <= 0xa6))
+	{
+		if (lhs.type != f64)
+			return false;
+
+		if (op == 0xa6)
+		{
+			result = constant{ f64, (lhs.bits & 0x7fffffffffffffffull) | (rhs.bits & 0x8000000000000000ull) };
+			return true;
+		}
+
+		const double a = asDouble(lhs.bits), b = asDouble(rhs.bits);
+		if (std::isnan(a) || std::isnan(b))
+			return false;
+
+		double r;
+		switch (op)
+		{
+		case 0x61: result = fromBool(a == b); return true;
+		case 0x62: result = fromBool(a != b); return true;
+		case 0x63: result = fromBool(a < b); return true;
+		case 0x64: result = fromBool(a > b); return true;
+		case 0x65: result = fromBool(a <= b); return true;
+		case 0x66: result = fromBool(a >= b); return true;
+		case 0xa0: r = a + b; break;
+		case 0xa1: r = a - b; break;
+		case 0xa2: r = a * b; break;
+		case 0xa3: r = a / b; break;
+		default:
+			if (a == 0 && b == 0)
+				return false;
+			r = op == 0xa4 ? std::fmin(a, b) : std::fmax(a, b);
+			break;
+		}
+		if (std::isnan(r))
+			return false;
+		result = fromDouble(r);
+		return true;
+	}
+
+	return false;
+}
+
+///	<summary>Folds locals that are written once and read once back into the expression that
+///	reads them, and turns tees of locals nobody reads into the value they tee. The def-use
+///	counts come from one sweep over the instructions; a second sweep does the folding.</summary>
+void Simplifier::inlineLocals(Function& func)
+{
+	const std::vector<statement*> ordered = inOrder(func);
+	if (ordered.empty())
+		return;
+
+	struct localUse
+	{
+		uint32_t writes = 0;
+		uint32_t reads = 0;
+		statement* def = nullptr; // The local_set, when it is the only write
+		statement* use = nullptr; // The local_get, when it is the only read
+	};
+	std::unordered_map<uint32_t, localUse> uses;
+
+	// barriers[i] counts the instructions before offset i that nothing may be moved
+	// past, so checking a stretch of the body is a subtraction.
+	std::vector<uint32_t> barriers(ordered.size() + 1, 0);
+	// stateReads does the same for loads and global_gets, which a call moved past them could change.
+	std::vector<uint32_t> stateReads(ordered.size() + 1, 0);
+	std::vector<int> writeOffsets; // Every local_set and local_tee, in order
+	std::vector<int> readOffsets; // Every local_get, in order
+	for (size_t i = 0; i < ordered.size(); ++i)
+	{
+		barriers[i + 1] = barriers[i];
+		stateReads[i + 1] = stateReads[i];
+		statement* node = ordered[i];
+		if (node == nullptr)
+			continue;
+
+		const byte op = node->operation.op.op;
+		if (op >= 0x20 && op <= 0x22)
+		{
+			int idx;
+			getNextu32(node->operation.bytes, 0, idx);
+			localUse& use = uses[idx];
+			if (op == 0x20)
+			{
+				use.reads++;
+				use.use = node;
+				readOffsets.push_back((int)i);
+				continue;
+			}
+
+			use.writes++;
+			use.def = op == 0x21 ? node : nullptr;
+			writeOffsets.push_back((int)i);
+			continue;
+		}
+
+		if (isBarrier(node->operation.op))
+			barriers[i + 1]++;
+		if (readsState(node->operation.op))
+			stateReads[i + 1]++;
+	}
+
+	// Going in order means a local feeding another one is folded first, so by the
+	// time the outer one is checked its expression already holds what it really reads.
+	std::unordered_set<statement*> folded;
+	for (statement* node : ordered)
+	{
+		if (node == nullptr)
+			continue;
+
+		const byte op = node->operation.op.op;
+		if (op != 0x21 && op != 0x22)
+			continue;
+
+		int idx;
+		getNextu32(node->operation.bytes, 0, idx);
+		const localUse& use = uses[idx];
+
+		// A tee nobody reads is just its value
+		if (op == 0x22)
+		{
+			if (use.reads == 0 && node->leftOperand != nullptr)
+				*node = *node->leftOperand;
+			continue;
+		}
+
+		if (use.writes != 1 || use.reads != 1 || use.def != node || node->leftOperand == nullptr
+			|| use.use->offset <= node->offset)
+			continue;
+
+		// Nothing between the write and the read may branch, call or touch memory...
+		const int from = node->offset + 1;
+		const int to = use.use->offset;
+		if (barriers[to] != barriers[from])
+			continue;
+
+		// ...or write a local the expression reads. Few writes sit in between in
+		// practice, so past a handful the local is simply left alone.
+		auto first = std::lower_bound(writeOffsets.begin(), writeOffsets.end(), from);
+		auto last = std::lower_bound(first, writeOffsets.end(), to);
+		if (last - first > 8)
+			continue;
+
+		bool clobbered = false;
+		for (auto it = first; it != last && !clobbered; ++it)
+		{
+			int written;
+			getNextu32(ordered[*it]->operation.bytes, 0, written);
+			int budget = 64;
+			clobbered = readsLocal(node->leftOperand, written, budget) || budget <= 0;
+		}
+		if (clobbered)
+			continue;
+
+		// The expression itself moves too, so what it does can't be seen in between either:
+		// a call can store to memory a load reads, and a tee can change a local that is read.
+		sideEffects effects;
+		int budget = 64;
+		if (!effectsOf(node->leftOperand, effects, budget))
+			continue;
+		if (effects.changesState && stateReads[to] != stateReads[from])
+			continue;
+		if (!effects.writes.empty())
+		{
+			auto firstRead = std::lower_bound(readOffsets.begin(), readOffsets.end(), from);
+			auto lastRead = std::lower_bound(firstRead, readOffsets.end(), to);
+			if (lastRead - firstRead > 8)
+				continue;
+
+			for (auto it = firstRead; it != lastRead && !clobbered; ++it)
+			{
+				int read;
+				getNextu32(ordered[*it]->operation.bytes, 0, read);
+				clobbered = std::find(effects.writes.begin(), effects.writes.end(), (uint32_t)read) != effects.writes.end();
+			}
+			if (clobbered)
+				continue;
+		}
+
+		*use.use = *node->leftOperand;
+		folded.insert(node);
+	}
+
+	if (folded.empty())
+		return;
+
+	func.statements.erase(std::remove_if(func.statements.begin(), func.statements.end(),
+		[&](statement* top) { return folded.count(top) != 0; }), func.statements.end());
+}
+
+///	<summary>Whether an expression reads a local. Gives up (returning true) once it has
+///	looked at 'budget' statements, so a deep expression can't make the pass slow.</summary>
+bool Simplifier::readsLocal(const statement* expr, uint32_t idx, int& budget)
+{
+	if (expr == nullptr)
+		return false;
+	if (--budget <= 0)
+		return true;
+
+	if (expr->operation.op.op == 0x20 || expr->operation.op.op == 0x22)
+	{
+		int read;
+		getNextu32(expr->operation.bytes, 0, read);
+		if ((uint32_t)read == idx)
+			return true;
+	}
+
+	if (readsLocal(expr->leftOperand, idx, budget) || readsLocal(expr->rightOperand, idx, budget))
+		return true;
+	for (const statement* argument : expr->arguments)
+	{
+		if (readsLocal(argument, idx, budget))
+			return true;
+	}
+	return false;
+}
+
+///	<summary>Collects what an expression does besides giving its value. Gives false once it
+///	has looked at 'budget' statements, so a deep expression is left where it is.</summary>
+bool Simplifier::effectsOf(const statement* expr, sideEffects& effects, int& budget)
+{
+	if (expr == nullptr)
+		return true;
+	if (--budget <= 0)
+		return false;
+
+	const byte op = expr->operation.op.op;
+	if (op == 0x10 || op == 0x11 || op == 0x24 || op == 0x40)
+		effects.changesState = true;
+	else if (op == 0x21 || op == 0x22)
+	{
+		int written;
+		getNextu32(expr->operation.bytes, 0, written);
+		effects.writes.push_back((uint32_t)written);
+	}
+
+	if (!effectsOf(expr->leftOperand, effects, budget) || !effectsOf(expr->rightOperand, effects, budget))
+		return false;
+	for (const statement* argument : expr->arguments)
+	{
+		if (!effectsOf(argument, effects, budget))
+			return false;
+	}
+	return true;
+}
+
+///	<summary>Instructions that read state a call could change: loads, global_get and memory_size.</summary>
+bool Simplifier::readsState(const opcodes::ins& ins)
+{
+	if (ins.op == 0x23 || ins.op == 0x3f)
+		return true;
+
+	const opcodes::memoryAccess access = opcodes::accessOf(ins);
+	return access.width != 0 && !access.store;
+}
+
+///	<summary>Instructions a local's value can't be moved past: anything that branches,
+///	calls or writes outside the locals. Loads in between only matter when the value itself
+///	calls or changes globals or memory size, which inlineLocals checks separately.</summary>
+bool Simplifier::isBarrier(const opcodes::ins& ins)
+{
+	if ((ins.op <= 0x05) || (ins.op >= 0x0b && ins.op <= 0x11))
+		return true;
+
+	switch (ins.op)
+	{
+	case 0x24: // global_set
+	case 0x40: // memory_grow
+		return true;
+	case 0xfc: // Only the saturating truncations are plain arithmetic
+		return ins.subOp >= 0x08;
+	default:
+		return opcodes::accessOf(ins).store;
+	}
+}
+
+///	<summary>Instructions where what is known about the locals stops being true: the
+///	places control can arrive from somewhere else (loop heads, else, end) and the
+///	places it never falls through (br, br_table, return, unreachable).</summary>
+bool Simplifier::isBlockBoundary(byte op)
+{
+	switch (op)
+	{
+	case 0x00: case 0x03: case 0x05: case 0x0b:
+	case 0x0c: case 0x0e: case 0x0f:
+		return true;
+	default:
+		return false;
+	}
+}
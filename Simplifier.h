@@ -0,0 +1,60 @@
+#ifndef SIMPLIFIER_H
+#define SIMPLIFIER_H
+#include <cstdint>
+#include <vector>
+#include "Function.h"
+
+///	<summary>A constant value as the simplifier works with it. Floats are kept
+///	as their raw bits so nothing is lost on the way through.</summary>
+struct constant
+{
+	dataTypes type = none;
+	uint64_t bits = 0;
+};
+
+///	<summary>
+///	Cleans up a decoded function so it reads less like the stack machine it came from:<br>
+///		1) Constant subexpressions are folded, following wasm's rules for wrapping,
+///		   shift counts and traps. Anything that would trap, or that involves a NaN
+///		   (whose bits wasm leaves open), is left alone.<br>
+///		2) A constant written to a local is put in place of the reads of that local
+///		   that follow it in the same basic block.<br>
+///		3) Operations that do nothing are dropped (x + 0, x * 1, x &lt;&lt; 0, ...), and
+///		   shifts left by a constant are shown as the multiplication they stand for.<br>
+///		4) Locals that are written once and read once, with nothing in between that
+///		   could change the value, are folded back into the expression reading them.
+///		   Tees of locals that are never read become the value they tee.<br>
+///	Statements are visited once in the order their instructions appear in the body,
+///	which is also an order where operands come before what uses them, so the whole
+///	pass is linear in the size of the function.
+///	</summary>
+class Simplifier
+{
+public:
+	static void run(Function& func);
+
+	static bool readConstant(const statement* node, constant& value);
+	static oper makeConstant(const constant& value);
+
+private:
+	///	<summary>What evaluating an expression does besides giving its value.</summary>
+	struct sideEffects
+	{
+		bool changesState = false; // A call, memory_grow or global_set, which can change what loads and global_get see
+		std::vector<uint32_t> writes{}; // Locals it sets or tees
+	};
+
+	static std::vector<statement*> inOrder(const Function& func);
+	static void foldConstants(Function& func);
+	static void inlineLocals(Function& func);
+	static bool readsLocal(const statement* expr, uint32_t idx, int& budget);
+	static bool effectsOf(const statement* expr, sideEffects& effects, int& budget);
+	static bool readsState(const opcodes::ins& ins);
+	static bool isBarrier(const opcodes::ins& ins);
+	static void simplifyStatement(statement* node);
+	static bool foldUnary(byte op, const constant& value, constant& result);
+	static bool foldBinary(byte op, const constant& lhs, const constant& rhs, constant& result);
+	static bool isBlockBoundary(byte op);
+};
+
+#endif // SIMPLIFIER_H
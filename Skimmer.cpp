@@ -0,0 +1,237 @@
+#include "Skimmer.h"
+#include <array>
+
+///	<summary>How the immediates of an opcode are laid out.</summary>
+enum immediateLayout : byte
+{
+	layoutLebs,			// 'count' unsigned LEBs
+	layoutMemargLane,	// Alignment and offset LEBs, then a lane byte
+	layoutSigned32,
+	layoutSigned64,
+	layoutF32,
+	layoutF64,
+	layoutBlockType,	// A signed 33 bit LEB. The single byte value types come out negative.
+	layoutLabels,		// br_table: a vector of labels, then the default
+	layoutTypes,		// Typed select: a vector of value types
+	layoutV128,
+	layoutLane,
+	layoutUnknown
+};
+
+struct layoutEntry
+{
+	const opcodes::ins* ins = &opcodes::error;
+	immediateLayout layout = layoutUnknown;
+	byte count = 0;
+};
+
+///	<summary>Works out the layout of an instruction from its description.</summary>
+static constexpr layoutEntry layoutOf(const opcodes::ins& ins, bool prefixed)
+{
+	layoutEntry entry{ &ins, layoutLebs, 0 };
+	if (ins.op == 0xef)
+		entry.layout = layoutUnknown;
+	else if (ins.imm == opcodes::immV128)
+		entry.layout = layoutV128;
+	else if (ins.imm == opcodes::immLane)
+		entry.layout = layoutLane;
+	else if (ins.imm == opcodes::immMemargLane)
+		entry.layout = layoutMemargLane;
+	else if (prefixed)
+		entry.count = (byte)ins.associatedBytes;
+	else if (ins.op >= 0x02 && ins.op <= 0x04)
+		entry.layout = layoutBlockType;
+	else if (ins.op >= 0x41 && ins.op <= 0x44)
+		entry.layout = (immediateLayout)(layoutSigned32 + (ins.op - 0x41));
+	else if (ins.associatedBytes == 0xff)
+		entry.layout = ins.op == 0x0e ? layoutLabels : layoutTypes;
+	else
+		entry.count = (byte)ins.associatedBytes;
+	return entry;
+}
+
+///	<summary>The layout of every opcode: the plain ones, then the 0xfc family, then the
+///	0xfd family, in the same order as the opcode tables. Worked out when compiling.</summary>
+static constexpr std::array<layoutEntry, 3 * 256> layouts = []
+{
+	std::array<layoutEntry, 3 * 256> entries{};
+	for (uint32_t i = 0; i < 256; ++i)
+	{
+		entries[i] = layoutOf(opcodes::plainTable[i], false);
+		entries[256 + i] = layoutOf(opcodes::bulkTable[i], true);
+		entries[512 + i] = layoutOf(opcodes::simdTable[i], true);
+	}
+	return entries;
+}();
+
+static const layoutEntry& lookup(uint32_t key)
+{
+	if (key <= 0xff)
+		return layouts[key];
+
+	const uint32_t sub = key & 0xffffff;
+	if (sub > 0xff)
+		return layouts[0xef];
+	return layouts[((key >> 24) == 0xfd ? 512 : 256) + sub];
+}
+
+///	<summary>Reads a LEB of at most 'maxLength' bytes. False if it doesn't end in time.</summary>
+static bool readLeb(const byte* code, size_t size, size_t& at, int maxLength, bool isSigned, uint64_t& value)
+{
+	value = 0;
+	int shift = 0;
+	for (int i = 0; i < maxLength && at < size; ++i)
+	{
+		const byte next = code[at++];
+		value |= (uint64_t)(next & 0x7f) << shift;
+		shift += 7;
+		if (next <= 0x7f)
+		{
+			if (isSigned && shift < 64 && (next & 0x40) != 0)
+				value |= ~0ull << shift;
+			return true;
+		}
+	}
+	return false;
+}
+
+Skimmer::Skimmer(const byte* code, size_t size)
+	: code(code), size(size)
+{
+}
+
+Skimmer::Skimmer(const std::vector<byte>& code)
+	: code(code.data()), size(code.size())
+{
+}
+
+///	<summary>Reads the next instruction into 'out'. False at the end of the code, or
+///	when the instruction can't be read.</summary>
+bool Skimmer::next(skimmedIns& out)
+{
+	if (hasFailed || at >= size)
+		return false;
+
+	const size_t start = at;
+	const byte op = code[at++];
+	uint32_t key = op;
+	if (op == 0xfc || op == 0xfd)
+	{
+		uint64_t sub;
+		if (!readLeb(code, size, at, 5, false, sub) || sub > 0xffffff)
+			return fail(start);
+		key = (uint32_t)op << 24 | (uint32_t)sub;
+	}
+
+	const layoutEntry& entry = lookup(key);
+	out.ins = entry.ins;
+	out.key = key;
+	out.offset = (uint32_t)start;
+	out.immediateCount = 0;
+	out.raw = nullptr;
+	out.rawLength = 0;
+
+	uint64_t* immediates = out.immediates;
+	switch (entry.layout)
+	{
+	case layoutLebs:
+		for (int k = 0; k < entry.count; ++k)
+		{
+			if (!readLeb(code, size, at, 5, false, immediates[k]))
+				return fail(start);
+		}
+		out.immediateCount = entry.count;
+		break;
+
+	case layoutMemargLane:
+		if (!readLeb(code, size, at, 5, false, immediates[0]) || !readLeb(code, size, at, 5, false, immediates[1]) || at >= size)
+			return fail(start);
+		immediates[2] = code[at++];
+		out.immediateCount = 3;
+		break;
+
+	case layoutSigned32:
+	case layoutSigned64:
+	case layoutBlockType:
+		if (!readLeb(code, size, at, entry.layout == layoutSigned64 ? 10 : 5, true, immediates[0]))
+			return fail(start);
+		out.immediateCount = 1;
+		break;
+
+	case layoutF32:
+	case layoutF64:
+	{
+		const size_t width = entry.layout == layoutF32 ? 4 : 8;
+		if (size - at < width)
+			return fail(start);
+		immediates[0] = 0;
+		for (size_t k = 0; k < width; ++k)
+			immediates[0] |= (uint64_t)code[at + k] << (8 * k);
+		at += width;
+		out.immediateCount = 1;
+		break;
+	}
+
+	case layoutLabels:
+	case layoutTypes:
+	{
+		if (!readLeb(code, size, at, 5, false, immediates[0]))
+			return fail(start);
+		const uint64_t entries = immediates[0] + (entry.layout == layoutLabels ? 1 : 0);
+		if (entries > size - at)
+			return fail(start);
+
+		const size_t first = at;
+		uint64_t skipped;
+		for (uint64_t k = 0; k < entries; ++k)
+		{
+			if (!readLeb(code, size, at, 5, false, skipped))
+				return fail(start);
+		}
+		out.raw = code + first;
+		out.rawLength = (uint32_t)(at - first);
+		out.immediateCount = 1;
+		break;
+	}
+
+	case layoutV128:
+		if (size - at < 16)
+			return fail(start);
+		out.raw = code + at;
+		out.rawLength = 16;
+		at += 16;
+		break;
+
+	case layoutLane:
+		if (at >= size)
+			return fail(start);
+		immediates[0] = code[at++];
+		out.immediateCount = 1;
+		break;
+
+	default:
+		return fail(start);
+	}
+
+	out.length = (uint32_t)(at - start);
+	return true;
+}
+
+///	<summary>True when the walk stopped at something it couldn't read rather than at the end.</summary>
+bool Skimmer::failed() const
+{
+	return hasFailed;
+}
+
+///	<summary>Where the next instruction starts, or where the one that couldn't be read does.</summary>
+size_t Skimmer::position() const
+{
+	return at;
+}
+
+bool Skimmer::fail(size_t start)
+{
+	hasFailed = true;
+	at = start;
+	return false;
+}
@@ -0,0 +1,58 @@
+#ifndef SKIMMER_H
+#define SKIMMER_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "opcodes.h"
+
+typedef unsigned char byte;
+
+///	<summary>One instruction as the skimmer reads it. The offset is from the start of
+///	the code it was given.</summary>
+struct skimmedIns
+{
+	const opcodes::ins* ins = nullptr;
+	uint32_t key = 0; // The opcode, or prefix << 24 | sub-opcode for the 0xfc and 0xfd families
+	uint32_t offset = 0;
+	uint32_t length = 0; // The opcode and its immediates
+	///	<summary>The immediates in the order they are written: indices, labels, memarg
+	///	alignment and offset, lanes, constants and block types. Signed ones (constants,
+	///	block types) are sign extended, and floats are their raw bits. Vectors give their
+	///	length here and leave the entries in 'raw'.</summary>
+	uint64_t immediates[3] = {};
+	uint32_t immediateCount = 0;
+	const byte* raw = nullptr; // v128 bytes, or the entries of a br_table or typed select
+	uint32_t rawLength = 0;
+};
+
+///	<summary>
+///	Walks the instructions of a body without building anything from them. Each
+///	step looks the opcode up in a table that says how its immediates are laid out,
+///	reads them, and moves on, so skimming allocates nothing and costs little more
+///	than reading the bytes.<br>
+///	This is for anything that only needs to know where instructions are and what
+///	they say: profiles, offset lookups and the like. Decoding into statements is
+///	left to Function.<br>
+///	An instruction that isn't known, or whose immediates run past the end, stops
+///	the walk; position() then gives where it starts.
+///	</summary>
+class Skimmer
+{
+public:
+	Skimmer(const byte* code, size_t size);
+	explicit Skimmer(const std::vector<byte>& code);
+
+	bool next(skimmedIns& out);
+	bool failed() const;
+	size_t position() const;
+
+private:
+	bool fail(size_t start);
+
+	const byte* code;
+	size_t size;
+	size_t at = 0;
+	bool hasFailed = false;
+};
+
+#endif // SKIMMER_H
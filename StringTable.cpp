@@ -0,0 +1,61 @@
+#include "StringTable.h"
+#include <cstring>
+
+///	<summary>Returns the id of a string, copying it into the table the first time it is seen.</summary>
+StringTable::id StringTable::intern(std::string_view text)
+{
+	auto found = lookup.find(text);
+	if (found != lookup.end())
+		return found->second;
+
+	// Copy the text into the arena so the view outlives the caller's buffer
+	char* stored = allocate(text.size());
+	if (!text.empty())
+		memcpy(stored, text.data(), text.size());
+
+	std::string_view kept(stored, text.size());
+	const id ident = (id)strings.size();
+	strings.push_back(kept);
+	lookup.emplace(kept, ident);
+	return ident;
+}
+
+///	<summary>Returns the string behind an id.</summary>
+std::string_view StringTable::get(id ident) const
+{
+	return strings[ident];
+}
+
+///	<summary>Shorthand for interning a string and getting the stored view back.</summary>
+std::string_view StringTable::view(std::string_view text)
+{
+	return get(intern(text));
+}
+
+///	<summary>Number of distinct strings held.</summary>
+size_t StringTable::size() const
+{
+	return strings.size();
+}
+
+///	<summary>Hands out space from the current block, starting a new one when it runs out.
+///	Strings bigger than a block get a block of their own.</summary>
+char* StringTable::allocate(size_t length)
+{
+	if (length > blockSize)
+	{
+		blocks.emplace_back(new char[length]);
+		blockUsed = blockSize; // The big block is full, the next string starts a fresh one
+		return blocks.back().get();
+	}
+
+	if (blockUsed + length > blockSize)
+	{
+		blocks.emplace_back(new char[blockSize]);
+		blockUsed = 0;
+	}
+
+	char* start = blocks.back().get() + blockUsed;
+	blockUsed += length;
+	return start;
+}
@@ -0,0 +1,38 @@
+#ifndef STRINGTABLE_H
+#define STRINGTABLE_H
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+///	<summary>
+///	Module wide store for names. Each distinct string is copied once into
+///	large blocks and handed back as a small id or a string_view into those
+///	blocks, so a module with thousands of functions sharing names like
+///	"__i32_invar_0" holds one copy of each instead of one per function.<br>
+///	Interning is done while the Mediator sets the module up. After that
+///	the table is only read, and the views stay valid for its lifetime.
+///	</summary>
+class StringTable
+{
+public:
+	typedef uint32_t id;
+
+	id intern(std::string_view text);
+	std::string_view get(id ident) const;
+	std::string_view view(std::string_view text);
+	size_t size() const;
+
+private:
+	char* allocate(size_t length);
+
+	static const size_t blockSize = 64 * 1024;
+
+	std::vector<std::unique_ptr<char[]>> blocks;
+	size_t blockUsed = blockSize; // Forces the first allocation to make a block
+	std::vector<std::string_view> strings;
+	std::unordered_map<std::string_view, id> lookup;
+};
+
+#endif // STRINGTABLE_H
@@ -0,0 +1,142 @@
+#include "Symbolizer.h"
+#include "Skimmer.h"
+#include <algorithm>
+#include <sstream>
+
+///	<summary>Reads offsets from 'in', one or more per line, in decimal or with a 0x prefix,
+///	and writes one line per offset: the offset, then what is there.</summary>
+void Symbolizer::run(Mediator& module, std::istream& in, std::ostream& out)
+{
+	std::vector<std::string> tokens;
+	std::vector<uint32_t> offsets;
+	std::vector<bool> valid;
+	std::string token;
+	while (in >> token)
+	{
+		size_t used = 0;
+		unsigned long long value = 0;
+		try
+		{
+			value = std::stoull(token, &used, 0);
+		}
+		catch (const std::exception&)
+		{
+			used = 0;
+		}
+
+		tokens.push_back(token);
+		valid.push_back(used == token.size() && value <= UINT32_MAX);
+		offsets.push_back(valid.back() ? (uint32_t)value : 0);
+	}
+
+	const std::vector<std::string> results = resolve(module, offsets);
+	std::string text;
+	for (size_t i = 0; i < tokens.size(); ++i)
+	{
+		if (valid[i])
+			text += hex(offsets[i]) + ' ' + results[i] + '\n';
+		else
+			text += tokens[i] + " is not an offset\n";
+	}
+	out << text;
+}
+
+///	<summary>What is at each offset, in the order given. Offsets outside every body say so.</summary>
+std::vector<std::string> Symbolizer::resolve(Mediator& module, const std::vector<uint32_t>& offsets)
+{
+	std::vector<std::string> results(offsets.size());
+
+	// Sorting groups the offsets of each body together, so every body is visited once
+	std::vector<size_t> order(offsets.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return offsets[a] < offsets[b]; });
+
+	const BodyIndex& bodies = module.getBodyIndex();
+	std::vector<size_t> group;
+	int current = -1;
+	for (size_t i = 0; i <= order.size(); ++i)
+	{
+		const int body = i < order.size() ? bodies.find(offsets[order[i]]) : -1;
+		if (i < order.size() && body == current && body >= 0)
+		{
+			group.push_back(order[i]);
+			continue;
+		}
+
+		if (current >= 0)
+			resolveInBody(module, current, group, offsets, results);
+		group.clear();
+
+		current = body;
+		if (i < order.size())
+		{
+			if (body < 0)
+				results[order[i]] = "is not in a function body";
+			else
+				group.push_back(order[i]);
+		}
+	}
+
+	return results;
+}
+
+///	<summary>Skims one function and places every offset of 'order' that falls in its body.
+///	The offsets come sorted, so the body is walked once for all of them.</summary>
+void Symbolizer::resolveInBody(Mediator& module, int body, const std::vector<size_t>& order,
+	const std::vector<uint32_t>& offsets, std::vector<std::string>& results)
+{
+	const bodyEntry& entry = module.getBodyIndex().at(body);
+	const int index = module.getBodyFunction(body);
+	const Function& func = module.getFunction(index);
+
+	std::string name = std::string(func.getTitle());
+	if (name.empty())
+		name = "func_" + std::to_string(index);
+	const std::string where = name + " (function " + std::to_string(index) + ") ";
+
+	Skimmer skimmer(func.getBody());
+	skimmedIns current;
+	bool found = false;
+	for (size_t i : order)
+	{
+		const uint32_t offset = offsets[i];
+		std::string& result = results[i];
+		result = where + '+' + hex(offset - entry.offset) + ": ";
+		if (offset < entry.locals)
+		{
+			result += "body size";
+			continue;
+		}
+		if (offset < entry.code)
+		{
+			result += "locals declaration";
+			continue;
+		}
+
+		// Move up to the instruction holding the offset
+		const uint32_t relative = offset - entry.code;
+		while (!found || relative >= current.offset + current.length)
+		{
+			found = skimmer.next(current);
+			if (!found)
+				break;
+		}
+
+		if (found)
+			result += current.ins->symbol;
+		else if (skimmer.failed())
+			result += "past where decoding failed (unknown instruction at +" + hex(entry.code + (uint32_t)skimmer.position() - entry.offset) + ')';
+		else if (!func.getError().empty())
+			result += "past where decoding failed (" + func.getError() + ')';
+		else
+			result += "unknown";
+	}
+}
+
+std::string Symbolizer::hex(uint32_t value)
+{
+	std::ostringstream ss;
+	ss << "0x" << std::hex << value;
+	return ss.str();
+}
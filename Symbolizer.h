@@ -0,0 +1,29 @@
+#ifndef SYMBOLIZER_H
+#define SYMBOLIZER_H
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Mediator.h"
+
+///	<summary>
+///	Turns byte offsets into the module, as crash reports and stack traces give
+///	them, into the function and instruction at each one.<br>
+///	Offsets are resolved as a batch: they are sorted, each one is placed in its
+///	body with a binary search of the body index, and every function that is hit
+///	is skimmed once for all the offsets that fall inside it. Nothing is decoded.
+///	Answers come out in the order the offsets were given.
+///	</summary>
+class Symbolizer
+{
+public:
+	static void run(Mediator& module, std::istream& in, std::ostream& out);
+	static std::vector<std::string> resolve(Mediator& module, const std::vector<uint32_t>& offsets);
+
+private:
+	static void resolveInBody(Mediator& module, int body, const std::vector<size_t>& order,
+		const std::vector<uint32_t>& offsets, std::vector<std::string>& results);
+	static std::string hex(uint32_t value);
+};
+
+#endif // SYMBOLIZER_H
@@ -0,0 +1,132 @@
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../Module.h"
+#include "../Skimmer.h"
+
+// Every allocation in the process goes through here, so decoding can be held to account
+static std::atomic<size_t> allocations{ 0 };
+
+void* operator new(size_t size)
+{
+	allocations++;
+	if (void* block = std::malloc(size != 0 ? size : 1))
+		return block;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* block) noexcept
+{
+	std::free(block);
+}
+
+void operator delete(void* block, size_t) noexcept
+{
+	std::free(block);
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete[](void* block) noexcept
+{
+	std::free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept
+{
+	std::free(block);
+}
+
+// Decoding may allocate a few times per function (its first statement block, its first
+// argument list block and its list of statements), but not per instruction
+static const size_t mostPerFunction = 3;
+static const double mostPerInstruction = 0.05;
+
+///	<summary>Decodes every function of a module and counts the allocations it took against
+///	the number of instructions decoded. Gives false when there were too many.</summary>
+static bool checkModule(const std::string& path)
+{
+	decodeOptions options;
+	options.simplify = false;
+	Module module(path, options);
+	Mediator& mediator = module.getMediator();
+
+	size_t instructions = 0;
+	for (int i = 0; i < module.functionCount(); ++i)
+	{
+		Skimmer skimmer(module.function(i).getBody());
+		skimmedIns ins;
+		while (skimmer.next(ins))
+			instructions++;
+	}
+
+	// The first pass gives the decoder's scratch space the room it needs, the second is counted
+	size_t defined = 0;
+	for (int i = 0; i < module.functionCount(); ++i)
+	{
+		mediator.decodeFunction(i);
+		mediator.getFunction(i).release();
+		defined += module.function(i).isImported ? 0 : 1;
+	}
+
+	const size_t before = allocations;
+	for (int i = 0; i < module.functionCount(); ++i)
+		mediator.decodeFunction(i);
+	const size_t used = allocations - before;
+
+	const bool passed = used <= mostPerFunction * defined + mostPerInstruction * instructions;
+	std::cout << (passed ? "pass " : "FAIL ") << path << ": " << used << " allocations for "
+		<< defined << " functions and " << instructions << " instructions" << std::endl;
+	return passed;
+}
+
+///	<summary>Usage: AllocationTest [module or directory]... Defaults to the Tests directory.</summary>
+int main(int argc, char** argv)
+{
+	std::vector<std::string> paths;
+	for (int i = 1; i < argc; ++i)
+		paths.push_back(argv[i]);
+	if (paths.empty())
+		paths.push_back("Tests");
+
+	std::vector<std::string> modules;
+	for (const auto& path : paths)
+	{
+		if (!std::filesystem::is_directory(path))
+		{
+			modules.push_back(path);
+			continue;
+		}
+		for (const auto& entry : std::filesystem::directory_iterator(path))
+		{
+			if (entry.path().extension() == ".wasm")
+				modules.push_back(entry.path().string());
+		}
+	}
+
+	int failed = 0;
+	for (const auto& path : modules)
+	{
+		try
+		{
+			if (!checkModule(path))
+				failed++;
+		}
+		catch (const std::exception& e)
+		{
+			std::cout << "FAIL " << path << ": " << e.what() << std::endl;
+			failed++;
+		}
+	}
+
+	std::cout << modules.size() - failed << " of " << modules.size() << " modules passed" << std::endl;
+	return failed == 0 ? 0 : 1;
+}
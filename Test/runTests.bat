@@ -16,6 +16,9 @@ for %%f in (.\Tests\*.wasm) do (
     ..\Debug\wasmDecomp.exe %%f > %%f_out.txt
 )
 
+REM decoding must not allocate per instruction
+..\Debug\AllocationTest.exe .\Tests
+
 REM move all the output files back up a level
 for %%f in (.\Tests\*.txt) do (
     echo Moving %%f. . .
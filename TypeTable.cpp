@@ -0,0 +1,75 @@
+#include "TypeTable.h"
+#include <map>
+#include <utility>
+
+///	<summary>Takes the type section entries and the type section index of every function.
+///	Duplicate entries are folded together, and every index is rewritten to the
+///	canonical one so nothing has to translate them afterwards.</summary>
+TypeTable::TypeTable(std::vector<signature> sectionTypes, std::vector<uint32_t> sectionFuncTypes)
+{
+	// Signatures are keyed by their exact type bytes; the names follow from those.
+	std::map<std::vector<unsigned char>, uint32_t> seen;
+	canonical.reserve(sectionTypes.size());
+	for (auto& sig : sectionTypes)
+	{
+		auto found = seen.emplace(sig.encoding, (uint32_t)types.size());
+		if (found.second)
+			types.push_back(std::move(sig));
+		canonical.push_back(found.first->second);
+	}
+
+	funcTypes.reserve(sectionFuncTypes.size());
+	for (uint32_t typeIdx : sectionFuncTypes)
+		funcTypes.push_back(canonicalType(typeIdx));
+}
+
+///	<summary>Returns the signature at a type section index, or nullptr if the index is out of range.</summary>
+const signature* TypeTable::typeAt(uint32_t typeIdx) const
+{
+	return signatureAt(canonicalType(typeIdx));
+}
+
+///	<summary>Returns the signature at a canonical index, or nullptr if the index is out of range.</summary>
+const signature* TypeTable::signatureAt(uint32_t canonicalIdx) const
+{
+	if (canonicalIdx >= types.size())
+		return nullptr;
+
+	return &types[canonicalIdx];
+}
+
+///	<summary>Returns the signature of the function at a function index, or nullptr
+///	if the function is unknown.</summary>
+const signature* TypeTable::funcSignature(uint32_t funcIdx) const
+{
+	return signatureAt(funcType(funcIdx));
+}
+
+///	<summary>Maps a type section index to its canonical index, or noType.</summary>
+uint32_t TypeTable::canonicalType(uint32_t typeIdx) const
+{
+	if (typeIdx >= canonical.size())
+		return noType;
+
+	return canonical[typeIdx];
+}
+
+///	<summary>The canonical type index of a function, or noType.</summary>
+uint32_t TypeTable::funcType(uint32_t funcIdx) const
+{
+	if (funcIdx >= funcTypes.size())
+		return noType;
+
+	return funcTypes[funcIdx];
+}
+
+///	<summary>Number of distinct signatures.</summary>
+size_t TypeTable::typeCount() const
+{
+	return types.size();
+}
+
+size_t TypeTable::funcCount() const
+{
+	return funcTypes.size();
+}
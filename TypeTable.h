@@ -0,0 +1,103 @@
+#ifndef TYPETABLE_H
+#define TYPETABLE_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+///	<summary>Defines the data types that WASM works with.
+///	'none' is used in place of void, but they are equivalent
+///	</summary>
+enum dataTypes
+{
+	i32, // The iN values are interpreted as u32 until any operation occurs to convert them.
+	i64,
+	f32,
+	f64,
+	v128,
+
+	none // Placeholder for void
+};
+
+///	<summary>Simple struct to define what a full data definition looks like.</summary>
+struct dataDef
+{
+	dataTypes type{};
+	bool pointer = false;
+	std::string_view name{}; // Interned in the module's StringTable
+};
+
+///	<summary>Converts a value type byte from the binary into its data type.
+///	Anything this decoder does not know about becomes 'none'.</summary>
+inline dataTypes valueType(unsigned char code)
+{
+	switch (code)
+	{
+	case 0x7f: return i32;
+	case 0x7e: return i64;
+	case 0x7d: return f32;
+	case 0x7c: return f64;
+	case 0x7b: return v128;
+	default: return none;
+	}
+}
+
+///	<summary>The name a data type is printed with.</summary>
+inline const char* typeName(dataTypes type)
+{
+	switch (type)
+	{
+	case i32: return "i32";
+	case i64: return "i64";
+	case f32: return "f32";
+	case f64: return "f64";
+	case v128: return "v128";
+	default: return "void";
+	}
+}
+
+///	<summary>A single entry of the type section: what goes into a function
+///	and what comes back out of it. A function without inputs has an empty
+///	input list. Only the first result is shown, but 'encoding' keeps every parameter
+///	and result type byte just as the type section has them, so signatures that
+///	only differ in a later result or in a reference type still tell apart.</summary>
+struct signature
+{
+	std::vector<dataDef> inputs{};
+	dataDef output{};
+	std::vector<unsigned char> encoding{}; // Parameter count, parameter types, result count, result types
+};
+
+///	<summary>
+///	Read-only view of the module's signatures. It holds every distinct entry
+///	of the type section along with the type of every function (imported ones
+///	first, as they are in the function index space).<br>
+///	Entries of the type section with the same encoding are folded into one canonical
+///	type while the table is built, so two signatures are the same exactly when
+///	their type indices are, and functions only need to keep that index.<br>
+///	The table is built once by the Mediator and never modified afterwards,
+///	so any number of decoders may read from it at the same time without
+///	taking a lock.
+///	</summary>
+class TypeTable
+{
+public:
+	TypeTable(std::vector<signature> types, std::vector<uint32_t> funcTypes);
+
+	const signature* typeAt(uint32_t typeIdx) const;
+	const signature* signatureAt(uint32_t canonicalIdx) const;
+	const signature* funcSignature(uint32_t funcIdx) const;
+	uint32_t canonicalType(uint32_t typeIdx) const;
+	uint32_t funcType(uint32_t funcIdx) const;
+	size_t typeCount() const;
+	size_t funcCount() const;
+
+	static const uint32_t noType = UINT32_MAX;
+
+private:
+	std::vector<signature> types;		// Canonical signatures only
+	std::vector<uint32_t> canonical;	// Type section index -> canonical index
+	std::vector<uint32_t> funcTypes;	// Function index -> canonical index
+};
+
+#endif // TYPETABLE_H
@@ -0,0 +1,267 @@
+#include "WatEmitter.h"
+#include <cmath>
+#include <iomanip>
+#include <limits>
+
+///	<summary>Writes a float the way wat spells it.</summary>
+static std::string watFloat(double value, bool single)
+{
+	if (std::isnan(value))
+		return std::signbit(value) ? "-nan" : "nan";
+	if (std::isinf(value))
+		return value < 0 ? "-inf" : "inf";
+
+	std::ostringstream ss;
+	ss << std::setprecision(single ? std::numeric_limits<float>::max_digits10 : std::numeric_limits<double>::max_digits10) << value;
+	return ss.str();
+}
+
+const char* WatEmitter::name() const
+{
+	return "wat";
+}
+
+///	<summary>The decoder names instructions with underscores only; wat puts a dot after
+///	the type or section the instruction belongs to.</summary>
+std::string WatEmitter::instructionName(const opcodes::ins& ins)
+{
+	if (ins.op == 0x0f)
+		return "return";
+	if (ins.op == 0x11)
+		return "call_indirect";
+
+	static const char* prefixes[] = { "i32_", "i64_", "f32_", "f64_", "v128_", "i8x16_", "i16x8_", "i32x4_",
+		"i64x2_", "f32x4_", "f64x2_", "local_", "global_", "memory_", "table_", "data_", "elem_", "ref_" };
+	std::string name = ins.symbol;
+	for (const char* prefix : prefixes)
+	{
+		const size_t length = strlen(prefix);
+		if (name.compare(0, length, prefix) == 0)
+		{
+			name[length - 1] = '.';
+			break;
+		}
+	}
+	return name;
+}
+
+///	<summary>The (result ...) or (type ...) clause of a block, loop or if.</summary>
+std::string WatEmitter::blockType(const statement* node)
+{
+	const std::string type = blockTypeName(node->operation.bytes);
+	if (type.empty())
+		return "";
+	if (type.compare(0, 5, "type ") == 0)
+		return " (" + type + ')';
+	return " (result " + type + ')';
+}
+
+///	<summary>The indentation inside the current block. An if holds its body inside a
+///	(then ...) or (else ...), so it counts twice.</summary>
+int WatEmitter::depth(const emitState& state)
+{
+	return 1 + (int)state.open.size() + state.openIfs;
+}
+
+void WatEmitter::beginFunction(emitState& state, std::string& out) const
+{
+	const Function& func = state.func;
+	const signature& sig = func.getSignature();
+
+	out += "(func";
+	if (!func.getTitle().empty())
+		out += " $" + std::string(func.getTitle());
+	else if (state.index >= 0)
+		out += " $" + functionName(state.index);
+
+	for (const auto& input : sig.inputs)
+		out += std::string(" (param ") + typeName(input.type) + ')';
+	if (sig.output.type != none)
+		out += std::string(" (result ") + typeName(sig.output.type) + ')';
+	out += '\n';
+
+	// Every local is spelled out, up to a point. The point is for the whole function,
+	// since a declaration can hold any number of short runs.
+	static const uint32_t spelledOut = 1024;
+	uint32_t spelled = 0;
+	for (const auto& run : func.getLocals())
+	{
+		if (run.count == 0)
+			continue;
+
+		indent(1, out);
+		if (run.count > spelledOut - spelled)
+		{
+			out += ";; " + std::to_string(run.count) + " locals of type " + typeName(run.type) + '\n';
+			continue;
+		}
+
+		spelled += run.count;
+		out += "(local";
+		for (uint32_t i = 0; i < run.count; ++i)
+			out += std::string(" ") + typeName(run.type);
+		out += ")\n";
+	}
+}
+
+void WatEmitter::endFunction(emitState& /*state*/, std::string& out) const
+{
+	out += ")\n";
+}
+
+void WatEmitter::openBlock(const statement* node, emitState& state, std::string& out) const
+{
+	const int at = depth(state);
+	indent(at, out);
+	out += '(' + instructionName(node->operation.op) + blockType(node);
+
+	if (node->operation.op.op == 0x04)
+	{
+		if (node->leftOperand != nullptr)
+			out += ' ' + folded(node->leftOperand);
+		out += '\n';
+		indent(at + 1, out);
+		out += "(then";
+	}
+	out += '\n';
+}
+
+void WatEmitter::elseBlock(const statement* /*node*/, emitState& state, std::string& out) const
+{
+	const int at = depth(state) - 1;
+	indent(at, out);
+	out += ")\n";
+	indent(at, out);
+	out += "(else\n";
+}
+
+void WatEmitter::closeBlock(const statement* opener, emitState& state, std::string& out) const
+{
+	const int at = depth(state);
+	if (opener != nullptr && opener->operation.op.op == 0x04)
+	{
+		indent(at + 1, out);
+		out += ")\n";
+	}
+	indent(at, out);
+	out += ")\n";
+}
+
+///	<summary>The value a block ends with is left on the stack as the last thing in it.</summary>
+void WatEmitter::blockValue(const statement* value, emitState& state, std::string& out) const
+{
+	indent(depth(state), out);
+	out += folded(value) + '\n';
+}
+
+void WatEmitter::line(const statement* node, const statement* /*next*/, emitState& state, std::string& out) const
+{
+	// A value the decoder stands in for that nothing takes just stays on the stack
+	if (opcodes::isStandIn(node->operation.op))
+		return;
+
+	indent(depth(state), out);
+	out += folded(node);
+
+	const std::string comment = notes(node);
+	if (!comment.empty())
+		out += " ;; " + comment;
+	out += '\n';
+}
+
+void WatEmitter::decodeFailure(const statement* node, emitState& state, std::string& out) const
+{
+	indent(depth(state), out);
+	out += ";; could not decode past offset " + std::to_string(node->offset) + ": " + state.func.getError() + '\n';
+}
+
+///	<summary>Writes an instruction with its immediates, followed by its operands in the
+///	order they were pushed.</summary>
+std::string WatEmitter::folded(const statement* node) const
+{
+	static thread_local int depth = 0;
+	const depthGuard guard(depth);
+	if (guard.tooDeep())
+		return "(;...;)";
+
+	const opcodes::ins& ins = node->operation.op;
+	const auto& bytes = node->operation.bytes;
+	std::string text = '(' + instructionName(ins);
+
+	const opcodes::memoryAccess access = opcodes::accessOf(ins);
+	if (ins.op == 0x41 || ins.op == 0x42)
+	{
+		int64_t value;
+		getNexts64(bytes, 0, value);
+		text += ' ' + std::to_string(ins.op == 0x41 ? (int64_t)(int32_t)value : value);
+	}
+	else if (ins.op == 0x43 || ins.op == 0x44)
+	{
+		char raw[8] = {};
+		for (size_t i = 0; i < bytes.size() && i < 8; ++i)
+			raw[i] = bytes[i];
+		text += ' ' + (ins.op == 0x43 ? watFloat(decodeFloat(raw), true) : watFloat(decodeDouble(raw), false));
+	}
+	else if (ins.imm == opcodes::immV128)
+	{
+		std::ostringstream ss;
+		if (ins.subOp == 0x0c)
+		{
+			ss << " i32x4" << std::hex;
+			for (int lane = 0; lane + 3 < (int)bytes.size(); lane += 4)
+			{
+				uint32_t value = bytes[lane] | (bytes[lane + 1] << 8) | (bytes[lane + 2] << 16) | ((uint32_t)bytes[lane + 3] << 24);
+				ss << " 0x" << std::setw(8) << std::setfill('0') << value;
+			}
+		}
+		else
+		{
+			for (byte lane : bytes)
+				ss << ' ' << (int)lane;
+		}
+		text += ss.str();
+	}
+	else if (ins.imm == opcodes::immLane)
+	{
+		if (!bytes.empty())
+			text += ' ' + std::to_string(bytes[0]);
+	}
+	else if (access.width != 0)
+	{
+		// Only what differs from the defaults is written
+		if (node->operation.mem.offset != 0)
+			text += " offset=" + std::to_string(node->operation.mem.offset);
+		if (node->operation.mem.align < 32 && (1u << node->operation.mem.align) != (uint32_t)access.width)
+			text += " align=" + std::to_string(1u << node->operation.mem.align);
+		if (ins.imm == opcodes::immMemargLane && !bytes.empty())
+			text += ' ' + std::to_string(bytes.back());
+	}
+	else if (ins.op == 0x1c)
+	{
+		for (size_t i = 1; i < bytes.size(); ++i)
+			text += std::string(" (result ") + typeName(valueType(bytes[i])) + ')';
+	}
+	else if (ins.op == 0x11)
+	{
+		// The text format puts the table first, and leaves it out for table 0
+		auto values = immediates(node);
+		if (values.size() > 1 && values[1] != 0)
+			text += ' ' + std::to_string(values[1]);
+		if (!values.empty())
+			text += " (type " + std::to_string(values[0]) + ')';
+	}
+	else if (ins.op != 0x3f && ins.op != 0x40) // memory.size and grow only have a reserved byte
+	{
+		for (uint32_t value : immediates(node))
+			text += ' ' + std::to_string(value);
+	}
+
+	// The result of a block, and the value a br_if didn't branch with, are on the stack
+	// already, as the block or the br_if left them there
+	for (const statement* value : operands(node))
+	{
+		if (!opcodes::isStandIn(value->operation.op))
+			text += ' ' + folded(value);
+	}
+	return text + ')';
+}
@@ -0,0 +1,33 @@
+#ifndef WATEMITTER_H
+#define WATEMITTER_H
+#include "Emitter.h"
+
+///	<summary>
+///	Renders functions in the folded form of the WebAssembly text format, where
+///	every instruction is written as (name immediates operands...). Operands are
+///	nested where the decoder found them, so the output reads like the original
+///	source expressions while staying valid wat for a single function.
+///	</summary>
+class WatEmitter : public Emitter
+{
+public:
+	const char* name() const override;
+
+protected:
+	void beginFunction(emitState& state, std::string& out) const override;
+	void endFunction(emitState& state, std::string& out) const override;
+	void openBlock(const statement* node, emitState& state, std::string& out) const override;
+	void elseBlock(const statement* node, emitState& state, std::string& out) const override;
+	void closeBlock(const statement* opener, emitState& state, std::string& out) const override;
+	void blockValue(const statement* value, emitState& state, std::string& out) const override;
+	void line(const statement* node, const statement* next, emitState& state, std::string& out) const override;
+	void decodeFailure(const statement* node, emitState& state, std::string& out) const override;
+
+private:
+	std::string folded(const statement* node) const;
+	static std::string instructionName(const opcodes::ins& ins);
+	static std::string blockType(const statement* node);
+	static int depth(const emitState& state);
+};
+
+#endif // WATEMITTER_H
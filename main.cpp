@@ -1,24 +1,183 @@
 #include <iostream>
+#include <memory>
+#include <thread>
 
-#include "Sectioner.h"
-#include "Mediator.h"
+#include "Module.h"
+#include "Baseline.h"
+#include "Symbolizer.h"
+#include "Profiler.h"
+#include "FuzzHarness.h"
+#include "PseudoEmitter.h"
+#include "CEmitter.h"
+#include "WatEmitter.h"
 #include "opcodes.h"
 
 
+///	<summary>What the tool always says about a module before anything else.</summary>
+static void printHeader(const Sectioner& reader)
+{
+	std::cout << "WASM Version: " << reader.getVersion() << std::endl;
+	std::cout << "Done sectioning file." << std::endl << std::endl;
+	reader.sectionReport(std::cout);
+	std::cout << std::endl;
+}
+
 int main(int argc, char** argv)
 {
 	// Start by getting the wasm file from the input
-	// For now only the name of the file itself is being passed.
+	// Usage: wasmDecomp [--baseline <previous ir>] [--save-ir <ir file>] [--no-simplify]
+	//                   [--emit pseudo|c|wat] [--threads <count>] [--sections] [--save-index <file>] [--symbolize]
+	//                   [--profile-module csv|json] [--sort <key>] [--max-memory <megabytes>] <wasm file>
+	//        wasmDecomp --corpus <directory>
+	std::string filename;
+	std::string baselineFile;
+	std::string saveFile;
+	std::string indexFile;
+	decodeOptions options;
+	std::unique_ptr<Emitter> emitter = std::make_unique<PseudoEmitter>();
+	unsigned threads = std::thread::hardware_concurrency();
+	bool listSections = false;
+	bool symbolize = false;
+	bool corpus = false;
+	std::string profileFormat;
+	Profiler::sortKey profileOrder = Profiler::byIndex;
+	bool badArgs = false;
+	for (int i = 1; i < argc && !badArgs; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--baseline" && i + 1 < argc)
+			baselineFile = argv[++i];
+		else if (arg == "--save-ir" && i + 1 < argc)
+			saveFile = argv[++i];
+		else if (arg == "--no-simplify")
+			options.simplify = false;
+		else if (arg == "--sections")
+			listSections = true;
+		else if (arg == "--save-index" && i + 1 < argc)
+			indexFile = argv[++i];
+		else if (arg == "--index" && i + 1 < argc)
+			options.bodyIndexFile = argv[++i];
+		else if (arg == "--symbolize")
+			symbolize = true;
+		else if (arg == "--corpus")
+			corpus = true;
+		else if (arg == "--profile-module" && i + 1 < argc)
+		{
+			profileFormat = argv[++i];
+			badArgs = profileFormat != "csv" && profileFormat != "json";
+		}
+		else if (arg == "--sort" && i + 1 < argc)
+			badArgs = !Profiler::parseSortKey(argv[++i], profileOrder);
+		else if (arg == "--emit" && i + 1 < argc)
+		{
+			std::string format = argv[++i];
+			if (format == "c")
+				emitter = std::make_unique<CEmitter>();
+			else if (format == "wat")
+				emitter = std::make_unique<WatEmitter>();
+			else if (format != "pseudo")
+				badArgs = true;
+		}
+		else if (arg == "--threads" && i + 1 < argc)
+			threads = (unsigned)std::stoul(argv[++i]);
+		else if (arg == "--max-memory" && i + 1 < argc)
+		{
+			options.maxMemory = (size_t)std::stoull(argv[++i]) << 20;
+			badArgs = options.maxMemory == 0;
+		}
+		else if (filename.empty() && arg.rfind("--", 0) != 0)
+			filename = arg;
+		else
+			badArgs = true;
+	}
 
-	if (argc != 2)
+	if (badArgs || filename.empty())
 	{
 		std::cout << "Incorrect parameter passing. Try again with just the wasm filename." << std::endl;
+		std::cout << "Options: --baseline <previous ir> to only decode what changed since then," << std::endl;
+		std::cout << "         --save-ir <ir file> to keep this run as the next baseline," << std::endl;
+		std::cout << "         --no-simplify to print the functions exactly as decoded," << std::endl;
+		std::cout << "         --emit pseudo|c|wat to pick the output format (pseudo by default)," << std::endl;
+		std::cout << "         --threads <count> to render with that many threads," << std::endl;
+		std::cout << "         --sections to list where each section is in the file and stop," << std::endl;
+		std::cout << "         --save-index <file> to keep where every function body is for later tools," << std::endl;
+		std::cout << "         --index <file> to use a saved body index instead of scanning the code section," << std::endl;
+		std::cout << "         --symbolize to read module offsets from stdin and name what is at each," << std::endl;
+		std::cout << "         --profile-module csv|json to report the size and instruction mix of each function," << std::endl;
+		std::cout << "         --sort index|size|instructions|depth|calls|memory to order that report," << std::endl;
+		std::cout << "         --max-memory <megabytes> to render one function at a time within that budget." << std::endl;
+		std::cout << "Or: --corpus <directory> to decompile every file under it and report the slowest ones." << std::endl;
 		exit(1);
 	}
-	std::string filename = argv[1];
-	std::cout << filename << std::endl;
 
-	// TODO: Verify the file is a well-formed.
-	Sectioner reader = Sectioner(filename);
-	Mediator middle = Mediator(&reader);
+	// The profile and the symbolized offsets are read by other tools, so they are all that goes to stdout
+	const bool profiling = !profileFormat.empty();
+	const bool toolOutput = profiling || symbolize;
+	if (!toolOutput)
+		std::cout << filename << std::endl;
+
+	// A malformed function only costs itself, but a file that can't be read or sectioned ends the run.
+	try
+	{
+		if (corpus)
+		{
+			FuzzHarness::runCorpus(filename, std::cout);
+			return 0;
+		}
+
+		// Listing the sections doesn't need anything else read
+		if (listSections)
+		{
+			Sectioner reader = Sectioner(filename);
+			printHeader(reader);
+			reader.printDirectory(std::cout);
+			return 0;
+		}
+
+		// Functions are decoded as they are rendered, so the decoding is spread over the threads too.
+		Module module(filename, options);
+		if (!toolOutput)
+			printHeader(module.getSections());
+		Mediator& middle = module.getMediator();
+		module.prepare(*emitter);
+		if (!indexFile.empty())
+			middle.getBodyIndex().save(indexFile);
+
+		if (symbolize)
+		{
+			Symbolizer::run(middle, std::cin, std::cout);
+			return 0;
+		}
+
+		if (profiling)
+		{
+			auto profiles = Profiler::profile(middle, threads);
+			Profiler::sort(profiles, profileOrder);
+			if (profileFormat == "csv")
+				Profiler::writeCsv(profiles, std::cout);
+			else
+				Profiler::writeJson(profiles, std::cout);
+			return 0;
+		}
+
+		// Without a baseline every function is decoded and printed like always.
+		if (baselineFile.empty())
+		{
+			if (!saveFile.empty())
+				Baseline::fromModule(middle, *emitter).save(saveFile);
+			middle.emitFunctions(*emitter, std::cout, threads);
+			return 0;
+		}
+
+		// With one, only the functions that changed get decoded, and those are printed as a diff.
+		Baseline next;
+		Baseline::load(baselineFile).compare(middle, *emitter, std::cout, next);
+		if (!saveFile.empty())
+			next.save(saveFile);
+	}
+	catch (const std::exception& e)
+	{
+		(toolOutput ? std::cerr : std::cout) << "Error: " << e.what() << std::endl;
+		return 1;
+	}
 }
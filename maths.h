@@ -1,6 +1,7 @@
 #ifndef MATHS_H
 #define MATHS_H
 #include <cstdint>
+#include <vector>
 
 /// <summary>
 /// Unsigned 32-bit LEB decoder. Takes in 4 bytes, returns an int. <br>
@@ -99,36 +100,103 @@ inline double decodeDouble(char* bytes)
 
 
 /// <summary>Given a Byte string, we can figure out the bytes in the next u32
-/// number.</summary>
-inline int nextu32Length(std::vector<unsigned char> in, int offset)
+/// number. Any container of bytes with size() and [] works, so instruction
+/// immediates can be read the same way as whole sections.</summary>
+template <typename Bytes>
+inline int nextu32Length(const Bytes& in, int offset)
 {
 	// Grab the first byte. If it is less than 0x80, we're done.
-	// Continue for up to 4 bytes max
-	for(int i = offset; i < offset + 4; ++i)
+	// Continue for up to 5 bytes max, since each byte holds 7 bits.
+	// Nothing is left to read past the end, so that gives no bytes at all.
+	if (offset < 0 || offset >= (int)in.size())
+		return 0;
+	int stop = offset + 5 < (int)in.size() ? offset + 5 : (int)in.size();
+	for(int i = offset; i < stop; ++i)
 	{
 		unsigned char byte = in[i];
 		if (byte < 0x80)
 			return i - offset + 1;
 	}
-	return 4;
+	return stop - offset;
 }
 
 /// <summary>Grab the next instance of a u32 number. Returns the number of bytes it occupied.
 /// The value is passed back by reference. </summary>
-inline int getNextu32(std::vector<unsigned char> in, int offset, int& value)
+template <typename Bytes>
+inline int getNextu32(const Bytes& in, int offset, int& value)
 {
 	int length = nextu32Length(in, offset);
 
-	// Knowing the length, extract those bytes and pass it to the decoder.
-	char temp[4] = {static_cast<char>(0x80), static_cast<char>(0x80), static_cast<char>(0x80), static_cast<char>(0x80)};
-	
+	// Knowing the length, decode those bytes. This can't go through u_decLEB32
+	// because padded encodings use the full 5 bytes.
+	uint32_t result = 0;
+	int shift = 0;
 	for(int i = offset; i < offset + length; ++i)
 	{
-		temp[i - offset] = in[i];
+		result |= (uint32_t)(in[i] & 0x7f) << shift;
+		shift += 7;
 	}
-	value = u_decLEB32(temp);
+	value = (int)result;
 
 	return length;
 }
 
+/// <summary>Grab the next signed LEB number, up to 64 bits wide. Returns the number of
+/// bytes it occupied. i32 and i64 constants are both encoded like this.</summary>
+template <typename Bytes>
+inline int getNexts64(const Bytes& in, int offset, int64_t& value)
+{
+	uint64_t result = 0;
+	int shift = 0;
+	int i = offset;
+	unsigned char byte = 0x80;
+	while (i < (int)in.size() && shift < 64 && byte > 0x7f)
+	{
+		byte = in[i];
+		result |= (uint64_t)(byte & 0x7f) << shift;
+		shift += 7;
+		i++;
+	}
+
+	// Sign extend from the last bit that was read
+	if (shift < 64 && (byte & 0x40))
+		result |= ~(uint64_t)0 << shift;
+	value = (int64_t)result;
+
+	return i - offset;
+}
+
+/// <summary>Signed LEB encoder, the inverse of getNexts64. Uses as few bytes as possible.</summary>
+inline std::vector<unsigned char> encodeSLEB(int64_t value)
+{
+	std::vector<unsigned char> out;
+	bool more = true;
+	while (more)
+	{
+		unsigned char byte = value & 0x7f;
+		value >>= 7; // Arithmetic shift keeps the sign
+
+		if ((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40)))
+			more = false;
+		else
+			byte |= 0x80;
+		out.push_back(byte);
+	}
+	return out;
+}
+
+/// <summary>64-bit FNV-1a hash of a run of bytes. Not cryptographic, only used to
+/// tell whether a function body is still the same as in an earlier build.
+/// Pass a previous result as the seed to hash several runs as one.</summary>
+inline uint64_t hashBytes(const unsigned char* data, size_t length, uint64_t seed = 14695981039346656037ull)
+{
+	uint64_t hash = seed;
+	for (size_t i = 0; i < length; ++i)
+	{
+		hash ^= data[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
 #endif // MATHS_H
\ No newline at end of file
@@ -0,0 +1,454 @@
+#ifndef OPCODELIST_H
+#define OPCODELIST_H
+
+/// <summary>
+/// Every instruction the decoder knows, one line each. The opcode tables in
+/// opcodes.h are generated from these lists, so this is the only place an
+/// instruction is described. Each line is
+///		X(opcode, symbol, immediates, LEBs, operands, result, operand types...)
+/// - opcode: the byte, or the sub-opcode for the prefixed lists
+/// - immediates: how the bytes after the opcode are laid out
+/// - LEBs: how many LEB immediates follow; 0xff for a vector
+/// - operands: how many values the instruction takes off the stack
+/// - result and operand types: none when there isn't one, any when it depends on
+///   a local, global or signature
+/// Opcodes that aren't listed decode as errors.
+/// </summary>
+
+// Single byte opcodes
+#define PLAIN_OPCODES(X) \
+	X(0x00, "unreachable",                     immLeb,           0, 0, none, none, none, none) \
+	X(0x01, "nop",                             immLeb,           0, 0, none, none, none, none) \
+	X(0x02, "block",                           immLeb,           0, 0, none, none, none, none) \
+	X(0x03, "loop",                            immLeb,           0, 0, none, none, none, none) \
+	X(0x04, "if",                              immLeb,           0, 1, none, i32, none, none) \
+	X(0x05, "else",                            immLeb,           0, 0, none, none, none, none) \
+	X(0x0b, "end",                             immLeb,           0, 0, none, none, none, none) \
+	X(0x0c, "br",                              immLeb,           1, 0, none, none, none, none) \
+	X(0x0d, "br_if",                           immLeb,           1, 1, none, i32, none, none) \
+	X(0x0e, "br_table",                        immLeb,        0xff, 1, none, i32, none, none) \
+	X(0x0f, "ret",                             immLeb,           0, 0, none, none, none, none) \
+	X(0x10, "call",                            immLeb,           1, 0, any,  none, none, none) \
+	X(0x11, "call_indir",                      immLeb,           2, 0, any,  none, none, none) \
+	X(0x1a, "drop",                            immLeb,           0, 1, none, any, none, none) \
+	X(0x1b, "select",                          immLeb,           0, 3, any,  any, any, i32) \
+	X(0x1c, "select",                          immLeb,        0xff, 3, any,  any, any, i32) \
+	X(0x20, "local_get",                       immLeb,           1, 0, any,  none, none, none) \
+	X(0x21, "local_set",                       immLeb,           1, 1, none, any, none, none) \
+	X(0x22, "local_tee",                       immLeb,           1, 1, any,  any, none, none) \
+	X(0x23, "global_get",                      immLeb,           1, 0, any,  none, none, none) \
+	X(0x24, "global_set",                      immLeb,           1, 1, none, any, none, none) \
+	X(0x28, "i32_load",                        immLeb,           2, 1, i32,  i32, none, none) \
+	X(0x29, "i64_load",                        immLeb,           2, 1, i64,  i32, none, none) \
+	X(0x2a, "f32_load",                        immLeb,           2, 1, f32,  i32, none, none) \
+	X(0x2b, "f64_load",                        immLeb,           2, 1, f64,  i32, none, none) \
+	X(0x2c, "i32_load8_s",                     immLeb,           2, 1, i32,  i32, none, none) \
+	X(0x2d, "i32_load8_u",                     immLeb,           2, 1, i32,  i32, none, none) \
+	X(0x2e, "i32_load16_s",                    immLeb,           2, 1, i32,  i32, none, none) \
+	X(0x2f, "i32_load16_u",                    immLeb,           2, 1, i32,  i32, none, none) \
+	X(0x30, "i64_load8_s",                     immLeb,           2, 1, i64,  i32, none, none) \
+	X(0x31, "i64_load8_u",                     immLeb,           2, 1, i64,  i32, none, none) \
+	X(0x32, "i64_load16_s",                    immLeb,           2, 1, i64,  i32, none, none) \
+	X(0x33, "i64_load16_u",                    immLeb,           2, 1, i64,  i32, none, none) \
+	X(0x34, "i64_load32_s",                    immLeb,           2, 1, i64,  i32, none, none) \
+	X(0x35, "i64_load32_u",                    immLeb,           2, 1, i64,  i32, none, none) \
+	X(0x36, "i32_store",                       immLeb,           2, 2, none, i32, i32, none) \
+	X(0x37, "i64_store",                       immLeb,           2, 2, none, i32, i64, none) \
+	X(0x38, "f32_store",                       immLeb,           2, 2, none, i32, f32, none) \
+	X(0x39, "f64_store",                       immLeb,           2, 2, none, i32, f64, none) \
+	X(0x3a, "i32_store8",                      immLeb,           2, 2, none, i32, i32, none) \
+	X(0x3b, "i32_store16",                     immLeb,           2, 2, none, i32, i32, none) \
+	X(0x3c, "i64_store8",                      immLeb,           2, 2, none, i32, i64, none) \
+	X(0x3d, "i64_store16",                     immLeb,           2, 2, none, i32, i64, none) \
+	X(0x3e, "i64_store32",                     immLeb,           2, 2, none, i32, i64, none) \
+	X(0x3f, "memory_size",                     immLeb,           1, 0, i32,  none, none, none) \
+	X(0x40, "memory_grow",                     immLeb,           1, 1, i32,  i32, none, none) \
+	X(0x41, "i32_const",                       immLeb,           1, 0, i32,  none, none, none) \
+	X(0x42, "i64_const",                       immLeb,           1, 0, i64,  none, none, none) \
+	X(0x43, "f32_const",                       immLeb,           1, 0, f32,  none, none, none) \
+	X(0x44, "f64_const",                       immLeb,           1, 0, f64,  none, none, none) \
+	X(0x45, "i32_eqz",                         immLeb,           0, 1, i32,  i32, none, none) \
+	X(0x46, "i32_eq",                          immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x47, "i32_ne",                          immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x48, "i32_lt_s",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x49, "i32_lt_u",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x4a, "i32_gt_s",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x4b, "i32_gt_u",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x4c, "i32_le_s",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x4d, "i32_le_u",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x4e, "i32_ge_s",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x4f, "i32_ge_u",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x50, "i64_eqz",                         immLeb,           0, 1, i32,  i64, none, none) \
+	X(0x51, "i64_eq",                          immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x52, "i64_ne",                          immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x53, "i64_lt_s",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x54, "i64_lt_u",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x55, "i64_gt_s",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x56, "i64_gt_u",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x57, "i64_le_s",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x58, "i64_le_u",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x59, "i64_ge_s",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x5a, "i64_ge_u",                        immLeb,           0, 2, i32,  i64, i64, none) \
+	X(0x5b, "f32_eq",                          immLeb,           0, 2, i32,  f32, f32, none) \
+	X(0x5c, "f32_ne",                          immLeb,           0, 2, i32,  f32, f32, none) \
+	X(0x5d, "f32_lt",                          immLeb,           0, 2, i32,  f32, f32, none) \
+	X(0x5e, "f32_gt",                          immLeb,           0, 2, i32,  f32, f32, none) \
+	X(0x5f, "f32_le",                          immLeb,           0, 2, i32,  f32, f32, none) \
+	X(0x60, "f32_ge",                          immLeb,           0, 2, i32,  f32, f32, none) \
+	X(0x61, "f64_eq",                          immLeb,           0, 2, i32,  f64, f64, none) \
+	X(0x62, "f64_ne",                          immLeb,           0, 2, i32,  f64, f64, none) \
+	X(0x63, "f64_lt",                          immLeb,           0, 2, i32,  f64, f64, none) \
+	X(0x64, "f64_gt",                          immLeb,           0, 2, i32,  f64, f64, none) \
+	X(0x65, "f64_le",                          immLeb,           0, 2, i32,  f64, f64, none) \
+	X(0x66, "f64_ge",                          immLeb,           0, 2, i32,  f64, f64, none) \
+	X(0x67, "i32_clz",                         immLeb,           0, 1, i32,  i32, none, none) \
+	X(0x68, "i32_ctz",                         immLeb,           0, 1, i32,  i32, none, none) \
+	X(0x69, "i32_popcnt",                      immLeb,           0, 1, i32,  i32, none, none) \
+	X(0x6a, "i32_add",                         immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x6b, "i32_sub",                         immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x6c, "i32_mul",                         immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x6d, "i32_div_s",                       immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x6e, "i32_div_u",                       immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x6f, "i32_rem_s",                       immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x70, "i32_rem_u",                       immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x71, "i32_and",                         immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x72, "i32_or",                          immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x73, "i32_xor",                         immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x74, "i32_shl",                         immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x75, "i32_shr_s",                       immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x76, "i32_shr_u",                       immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x77, "i32_rotl",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x78, "i32_rotr",                        immLeb,           0, 2, i32,  i32, i32, none) \
+	X(0x79, "i64_clz",                         immLeb,           0, 1, i64,  i64, none, none) \
+	X(0x7a, "i64_ctz",                         immLeb,           0, 1, i64,  i64, none, none) \
+	X(0x7b, "i64_popcnt",                      immLeb,           0, 1, i64,  i64, none, none) \
+	X(0x7c, "i64_add",                         immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x7d, "i64_sub",                         immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x7e, "i64_mul",                         immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x7f, "i64_div_s",                       immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x80, "i64_div_u",                       immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x81, "i64_rem_s",                       immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x82, "i64_rem_u",                       immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x83, "i64_and",                         immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x84, "i64_or",                          immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x85, "i64_xor",                         immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x86, "i64_shl",                         immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x87, "i64_shr_s",                       immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x88, "i64_shr_u",                       immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x89, "i64_rotl",                        immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x8a, "i64_rotr",                        immLeb,           0, 2, i64,  i64, i64, none) \
+	X(0x8b, "f32_abs",                         immLeb,           0, 1, f32,  f32, none, none) \
+	X(0x8c, "f32_neg",                         immLeb,           0, 1, f32,  f32, none, none) \
+	X(0x8d, "f32_ceil",                        immLeb,           0, 1, f32,  f32, none, none) \
+	X(0x8e, "f32_floor",                       immLeb,           0, 1, f32,  f32, none, none) \
+	X(0x8f, "f32_trunc",                       immLeb,           0, 1, f32,  f32, none, none) \
+	X(0x90, "f32_nearest",                     immLeb,           0, 1, f32,  f32, none, none) \
+	X(0x91, "f32_sqrt",                        immLeb,           0, 1, f32,  f32, none, none) \
+	X(0x92, "f32_add",                         immLeb,           0, 2, f32,  f32, f32, none) \
+	X(0x93, "f32_sub",                         immLeb,           0, 2, f32,  f32, f32, none) \
+	X(0x94, "f32_mul",                         immLeb,           0, 2, f32,  f32, f32, none) \
+	X(0x95, "f32_div",                         immLeb,           0, 2, f32,  f32, f32, none) \
+	X(0x96, "f32_min",                         immLeb,           0, 2, f32,  f32, f32, none) \
+	X(0x97, "f32_max",                         immLeb,           0, 2, f32,  f32, f32, none) \
+	X(0x98, "f32_copysign",                    immLeb,           0, 2, f32,  f32, f32, none) \
+	X(0x99, "f64_abs",                         immLeb,           0, 1, f64,  f64, none, none) \
+	X(0x9a, "f64_neg",                         immLeb,           0, 1, f64,  f64, none, none) \
+	X(0x9b, "f64_ceil",                        immLeb,           0, 1, f64,  f64, none, none) \
+	X(0x9c, "f64_floor",                       immLeb,           0, 1, f64,  f64, none, none) \
+	X(0x9d, "f64_trunc",                       immLeb,           0, 1, f64,  f64, none, none) \
+	X(0x9e, "f64_nearest",                     immLeb,           0, 1, f64,  f64, none, none) \
+	X(0x9f, "f64_sqrt",                        immLeb,           0, 1, f64,  f64, none, none) \
+	X(0xa0, "f64_add",                         immLeb,           0, 2, f64,  f64, f64, none) \
+	X(0xa1, "f64_sub",                         immLeb,           0, 2, f64,  f64, f64, none) \
+	X(0xa2, "f64_mul",                         immLeb,           0, 2, f64,  f64, f64, none) \
+	X(0xa3, "f64_div",                         immLeb,           0, 2, f64,  f64, f64, none) \
+	X(0xa4, "f64_min",                         immLeb,           0, 2, f64,  f64, f64, none) \
+	X(0xa5, "f64_max",                         immLeb,           0, 2, f64,  f64, f64, none) \
+	X(0xa6, "f64_copysign",                    immLeb,           0, 2, f64,  f64, f64, none) \
+	X(0xa7, "i32_wrap_i64",                    immLeb,           0, 1, i32,  i64, none, none) \
+	X(0xa8, "i32_trunc_f32_s",                 immLeb,           0, 1, i32,  f32, none, none) \
+	X(0xa9, "i32_trunc_f32_u",                 immLeb,           0, 1, i32,  f32, none, none) \
+	X(0xaa, "i32_trunc_f64_s",                 immLeb,           0, 1, i32,  f64, none, none) \
+	X(0xab, "i32_trunc_f64_u",                 immLeb,           0, 1, i32,  f64, none, none) \
+	X(0xac, "i64_extend_i32_s",                immLeb,           0, 1, i64,  i32, none, none) \
+	X(0xad, "i64_extend_i32_u",                immLeb,           0, 1, i64,  i32, none, none) \
+	X(0xae, "i64_trunc_f32_s",                 immLeb,           0, 1, i64,  f32, none, none) \
+	X(0xaf, "i64_trunc_f32_u",                 immLeb,           0, 1, i64,  f32, none, none) \
+	X(0xb0, "i64_trunc_f64_s",                 immLeb,           0, 1, i64,  f64, none, none) \
+	X(0xb1, "i64_trunc_f64_u",                 immLeb,           0, 1, i64,  f64, none, none) \
+	X(0xb2, "f32_convert_i32_s",               immLeb,           0, 1, f32,  i32, none, none) \
+	X(0xb3, "f32_convert_i32_u",               immLeb,           0, 1, f32,  i32, none, none) \
+	X(0xb4, "f32_convert_i64_s",               immLeb,           0, 1, f32,  i64, none, none) \
+	X(0xb5, "f32_convert_i64_u",               immLeb,           0, 1, f32,  i64, none, none) \
+	X(0xb6, "f32_demote_f64",                  immLeb,           0, 1, f32,  f64, none, none) \
+	X(0xb7, "f64_convert_i32_s",               immLeb,           0, 1, f64,  i32, none, none) \
+	X(0xb8, "f64_convert_i32_u",               immLeb,           0, 1, f64,  i32, none, none) \
+	X(0xb9, "f64_convert_i64_s",               immLeb,           0, 1, f64,  i64, none, none) \
+	X(0xba, "f64_convert_i64_u",               immLeb,           0, 1, f64,  i64, none, none) \
+	X(0xbb, "f64_promote_f32",                 immLeb,           0, 1, f64,  f32, none, none) \
+	X(0xbc, "i32_reinterpret_f32",             immLeb,           0, 1, i32,  f32, none, none) \
+	X(0xbd, "i64_reinterpret_f64",             immLeb,           0, 1, i64,  f64, none, none) \
+	X(0xbe, "f32_reinterpret_i32",             immLeb,           0, 1, f32,  i32, none, none) \
+	X(0xbf, "f64_reinterpret_i64",             immLeb,           0, 1, f64,  i64, none, none)
+
+// Behind the 0xfc prefix: saturating truncation and bulk memory / table operations
+#define BULK_OPCODES(X) \
+	X(0x00, "i32_trunc_sat_f32_s",             immLeb,           0, 1, i32,  f32, none, none) \
+	X(0x01, "i32_trunc_sat_f32_u",             immLeb,           0, 1, i32,  f32, none, none) \
+	X(0x02, "i32_trunc_sat_f64_s",             immLeb,           0, 1, i32,  f64, none, none) \
+	X(0x03, "i32_trunc_sat_f64_u",             immLeb,           0, 1, i32,  f64, none, none) \
+	X(0x04, "i64_trunc_sat_f32_s",             immLeb,           0, 1, i64,  f32, none, none) \
+	X(0x05, "i64_trunc_sat_f32_u",             immLeb,           0, 1, i64,  f32, none, none) \
+	X(0x06, "i64_trunc_sat_f64_s",             immLeb,           0, 1, i64,  f64, none, none) \
+	X(0x07, "i64_trunc_sat_f64_u",             immLeb,           0, 1, i64,  f64, none, none) \
+	X(0x08, "memory_init",                     immLeb,           2, 3, none, i32, i32, i32) \
+	X(0x09, "data_drop",                       immLeb,           1, 0, none, none, none, none) \
+	X(0x0a, "memory_copy",                     immLeb,           2, 3, none, i32, i32, i32) \
+	X(0x0b, "memory_fill",                     immLeb,           1, 3, none, i32, i32, i32) \
+	X(0x0c, "table_init",                      immLeb,           2, 3, none, i32, i32, i32) \
+	X(0x0d, "elem_drop",                       immLeb,           1, 0, none, none, none, none) \
+	X(0x0e, "table_copy",                      immLeb,           2, 3, none, i32, i32, i32) \
+	X(0x0f, "table_grow",                      immLeb,           1, 2, i32,  any, i32, none) \
+	X(0x10, "table_size",                      immLeb,           1, 0, i32,  none, none, none) \
+	X(0x11, "table_fill",                      immLeb,           1, 3, none, i32, any, i32)
+
+// Behind the 0xfd prefix: fixed-width SIMD
+#define SIMD_OPCODES(X) \
+	X(0x00, "v128_load",                       immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x01, "v128_load8x8_s",                  immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x02, "v128_load8x8_u",                  immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x03, "v128_load16x4_s",                 immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x04, "v128_load16x4_u",                 immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x05, "v128_load32x2_s",                 immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x06, "v128_load32x2_u",                 immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x07, "v128_load8_splat",                immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x08, "v128_load16_splat",               immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x09, "v128_load32_splat",               immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x0a, "v128_load64_splat",               immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x0b, "v128_store",                      immMemarg,        2, 2, none, i32, v128, none) \
+	X(0x0c, "v128_const",                      immV128,          0, 0, v128, none, none, none) \
+	X(0x0d, "i8x16_shuffle",                   immV128,          0, 2, v128, v128, v128, none) \
+	X(0x0e, "i8x16_swizzle",                   immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x0f, "i8x16_splat",                     immLeb,           0, 1, v128, i32, none, none) \
+	X(0x10, "i16x8_splat",                     immLeb,           0, 1, v128, i32, none, none) \
+	X(0x11, "i32x4_splat",                     immLeb,           0, 1, v128, i32, none, none) \
+	X(0x12, "i64x2_splat",                     immLeb,           0, 1, v128, i64, none, none) \
+	X(0x13, "f32x4_splat",                     immLeb,           0, 1, v128, f32, none, none) \
+	X(0x14, "f64x2_splat",                     immLeb,           0, 1, v128, f64, none, none) \
+	X(0x15, "i8x16_extract_lane_s",            immLane,          0, 1, i32,  v128, none, none) \
+	X(0x16, "i8x16_extract_lane_u",            immLane,          0, 1, i32,  v128, none, none) \
+	X(0x17, "i8x16_replace_lane",              immLane,          0, 2, v128, v128, i32, none) \
+	X(0x18, "i16x8_extract_lane_s",            immLane,          0, 1, i32,  v128, none, none) \
+	X(0x19, "i16x8_extract_lane_u",            immLane,          0, 1, i32,  v128, none, none) \
+	X(0x1a, "i16x8_replace_lane",              immLane,          0, 2, v128, v128, i32, none) \
+	X(0x1b, "i32x4_extract_lane",              immLane,          0, 1, i32,  v128, none, none) \
+	X(0x1c, "i32x4_replace_lane",              immLane,          0, 2, v128, v128, i32, none) \
+	X(0x1d, "i64x2_extract_lane",              immLane,          0, 1, i64,  v128, none, none) \
+	X(0x1e, "i64x2_replace_lane",              immLane,          0, 2, v128, v128, i64, none) \
+	X(0x1f, "f32x4_extract_lane",              immLane,          0, 1, f32,  v128, none, none) \
+	X(0x20, "f32x4_replace_lane",              immLane,          0, 2, v128, v128, f32, none) \
+	X(0x21, "f64x2_extract_lane",              immLane,          0, 1, f64,  v128, none, none) \
+	X(0x22, "f64x2_replace_lane",              immLane,          0, 2, v128, v128, f64, none) \
+	X(0x23, "i8x16_eq",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x24, "i8x16_ne",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x25, "i8x16_lt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x26, "i8x16_lt_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x27, "i8x16_gt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x28, "i8x16_gt_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x29, "i8x16_le_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x2a, "i8x16_le_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x2b, "i8x16_ge_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x2c, "i8x16_ge_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x2d, "i16x8_eq",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x2e, "i16x8_ne",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x2f, "i16x8_lt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x30, "i16x8_lt_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x31, "i16x8_gt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x32, "i16x8_gt_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x33, "i16x8_le_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x34, "i16x8_le_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x35, "i16x8_ge_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x36, "i16x8_ge_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x37, "i32x4_eq",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x38, "i32x4_ne",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x39, "i32x4_lt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x3a, "i32x4_lt_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x3b, "i32x4_gt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x3c, "i32x4_gt_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x3d, "i32x4_le_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x3e, "i32x4_le_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x3f, "i32x4_ge_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x40, "i32x4_ge_u",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x41, "f32x4_eq",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x42, "f32x4_ne",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x43, "f32x4_lt",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x44, "f32x4_gt",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x45, "f32x4_le",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x46, "f32x4_ge",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x47, "f64x2_eq",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x48, "f64x2_ne",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x49, "f64x2_lt",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x4a, "f64x2_gt",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x4b, "f64x2_le",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x4c, "f64x2_ge",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x4d, "v128_not",                        immLeb,           0, 1, v128, v128, none, none) \
+	X(0x4e, "v128_and",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x4f, "v128_andnot",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x50, "v128_or",                         immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x51, "v128_xor",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x52, "v128_bitselect",                  immLeb,           0, 3, v128, v128, v128, v128) \
+	X(0x53, "v128_any_true",                   immLeb,           0, 1, i32,  v128, none, none) \
+	X(0x54, "v128_load8_lane",                 immMemargLane,    2, 2, v128, i32, v128, none) \
+	X(0x55, "v128_load16_lane",                immMemargLane,    2, 2, v128, i32, v128, none) \
+	X(0x56, "v128_load32_lane",                immMemargLane,    2, 2, v128, i32, v128, none) \
+	X(0x57, "v128_load64_lane",                immMemargLane,    2, 2, v128, i32, v128, none) \
+	X(0x58, "v128_store8_lane",                immMemargLane,    2, 2, none, i32, v128, none) \
+	X(0x59, "v128_store16_lane",               immMemargLane,    2, 2, none, i32, v128, none) \
+	X(0x5a, "v128_store32_lane",               immMemargLane,    2, 2, none, i32, v128, none) \
+	X(0x5b, "v128_store64_lane",               immMemargLane,    2, 2, none, i32, v128, none) \
+	X(0x5c, "v128_load32_zero",                immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x5d, "v128_load64_zero",                immMemarg,        2, 1, v128, i32, none, none) \
+	X(0x5e, "f32x4_demote_f64x2_zero",         immLeb,           0, 1, v128, v128, none, none) \
+	X(0x5f, "f64x2_promote_low_f32x4",         immLeb,           0, 1, v128, v128, none, none) \
+	X(0x60, "i8x16_abs",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0x61, "i8x16_neg",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0x62, "i8x16_popcnt",                    immLeb,           0, 1, v128, v128, none, none) \
+	X(0x63, "i8x16_all_true",                  immLeb,           0, 1, i32,  v128, none, none) \
+	X(0x64, "i8x16_bitmask",                   immLeb,           0, 1, i32,  v128, none, none) \
+	X(0x65, "i8x16_narrow_i16x8_s",            immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x66, "i8x16_narrow_i16x8_u",            immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x67, "f32x4_ceil",                      immLeb,           0, 1, v128, v128, none, none) \
+	X(0x68, "f32x4_floor",                     immLeb,           0, 1, v128, v128, none, none) \
+	X(0x69, "f32x4_trunc",                     immLeb,           0, 1, v128, v128, none, none) \
+	X(0x6a, "f32x4_nearest",                   immLeb,           0, 1, v128, v128, none, none) \
+	X(0x6b, "i8x16_shl",                       immLeb,           0, 2, v128, v128, i32, none) \
+	X(0x6c, "i8x16_shr_s",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0x6d, "i8x16_shr_u",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0x6e, "i8x16_add",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x6f, "i8x16_add_sat_s",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x70, "i8x16_add_sat_u",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x71, "i8x16_sub",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x72, "i8x16_sub_sat_s",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x73, "i8x16_sub_sat_u",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x74, "f64x2_ceil",                      immLeb,           0, 1, v128, v128, none, none) \
+	X(0x75, "f64x2_floor",                     immLeb,           0, 1, v128, v128, none, none) \
+	X(0x76, "i8x16_min_s",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x77, "i8x16_min_u",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x78, "i8x16_max_s",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x79, "i8x16_max_u",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x7a, "f64x2_trunc",                     immLeb,           0, 1, v128, v128, none, none) \
+	X(0x7b, "i8x16_avgr_u",                    immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x7c, "i16x8_extadd_pairwise_i8x16_s",   immLeb,           0, 1, v128, v128, none, none) \
+	X(0x7d, "i16x8_extadd_pairwise_i8x16_u",   immLeb,           0, 1, v128, v128, none, none) \
+	X(0x7e, "i32x4_extadd_pairwise_i16x8_s",   immLeb,           0, 1, v128, v128, none, none) \
+	X(0x7f, "i32x4_extadd_pairwise_i16x8_u",   immLeb,           0, 1, v128, v128, none, none) \
+	X(0x80, "i16x8_abs",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0x81, "i16x8_neg",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0x82, "i16x8_q15mulr_sat_s",             immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x83, "i16x8_all_true",                  immLeb,           0, 1, i32,  v128, none, none) \
+	X(0x84, "i16x8_bitmask",                   immLeb,           0, 1, i32,  v128, none, none) \
+	X(0x85, "i16x8_narrow_i32x4_s",            immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x86, "i16x8_narrow_i32x4_u",            immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x87, "i16x8_extend_low_i8x16_s",        immLeb,           0, 1, v128, v128, none, none) \
+	X(0x88, "i16x8_extend_high_i8x16_s",       immLeb,           0, 1, v128, v128, none, none) \
+	X(0x89, "i16x8_extend_low_i8x16_u",        immLeb,           0, 1, v128, v128, none, none) \
+	X(0x8a, "i16x8_extend_high_i8x16_u",       immLeb,           0, 1, v128, v128, none, none) \
+	X(0x8b, "i16x8_shl",                       immLeb,           0, 2, v128, v128, i32, none) \
+	X(0x8c, "i16x8_shr_s",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0x8d, "i16x8_shr_u",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0x8e, "i16x8_add",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x8f, "i16x8_add_sat_s",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x90, "i16x8_add_sat_u",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x91, "i16x8_sub",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x92, "i16x8_sub_sat_s",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x93, "i16x8_sub_sat_u",                 immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x94, "f64x2_nearest",                   immLeb,           0, 1, v128, v128, none, none) \
+	X(0x95, "i16x8_mul",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x96, "i16x8_min_s",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x97, "i16x8_min_u",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x98, "i16x8_max_s",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x99, "i16x8_max_u",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x9b, "i16x8_avgr_u",                    immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x9c, "i16x8_extmul_low_i8x16_s",        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x9d, "i16x8_extmul_high_i8x16_s",       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x9e, "i16x8_extmul_low_i8x16_u",        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0x9f, "i16x8_extmul_high_i8x16_u",       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xa0, "i32x4_abs",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xa1, "i32x4_neg",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xa3, "i32x4_all_true",                  immLeb,           0, 1, i32,  v128, none, none) \
+	X(0xa4, "i32x4_bitmask",                   immLeb,           0, 1, i32,  v128, none, none) \
+	X(0xa7, "i32x4_extend_low_i16x8_s",        immLeb,           0, 1, v128, v128, none, none) \
+	X(0xa8, "i32x4_extend_high_i16x8_s",       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xa9, "i32x4_extend_low_i16x8_u",        immLeb,           0, 1, v128, v128, none, none) \
+	X(0xaa, "i32x4_extend_high_i16x8_u",       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xab, "i32x4_shl",                       immLeb,           0, 2, v128, v128, i32, none) \
+	X(0xac, "i32x4_shr_s",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0xad, "i32x4_shr_u",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0xae, "i32x4_add",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xb1, "i32x4_sub",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xb5, "i32x4_mul",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xb6, "i32x4_min_s",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xb7, "i32x4_min_u",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xb8, "i32x4_max_s",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xb9, "i32x4_max_u",                     immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xba, "i32x4_dot_i16x8_s",               immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xbc, "i32x4_extmul_low_i16x8_s",        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xbd, "i32x4_extmul_high_i16x8_s",       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xbe, "i32x4_extmul_low_i16x8_u",        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xbf, "i32x4_extmul_high_i16x8_u",       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xc0, "i64x2_abs",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xc1, "i64x2_neg",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xc3, "i64x2_all_true",                  immLeb,           0, 1, i32,  v128, none, none) \
+	X(0xc4, "i64x2_bitmask",                   immLeb,           0, 1, i32,  v128, none, none) \
+	X(0xc7, "i64x2_extend_low_i32x4_s",        immLeb,           0, 1, v128, v128, none, none) \
+	X(0xc8, "i64x2_extend_high_i32x4_s",       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xc9, "i64x2_extend_low_i32x4_u",        immLeb,           0, 1, v128, v128, none, none) \
+	X(0xca, "i64x2_extend_high_i32x4_u",       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xcb, "i64x2_shl",                       immLeb,           0, 2, v128, v128, i32, none) \
+	X(0xcc, "i64x2_shr_s",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0xcd, "i64x2_shr_u",                     immLeb,           0, 2, v128, v128, i32, none) \
+	X(0xce, "i64x2_add",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xd1, "i64x2_sub",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xd5, "i64x2_mul",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xd6, "i64x2_eq",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xd7, "i64x2_ne",                        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xd8, "i64x2_lt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xd9, "i64x2_gt_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xda, "i64x2_le_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xdb, "i64x2_ge_s",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xdc, "i64x2_extmul_low_i32x4_s",        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xdd, "i64x2_extmul_high_i32x4_s",       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xde, "i64x2_extmul_low_i32x4_u",        immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xdf, "i64x2_extmul_high_i32x4_u",       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xe0, "f32x4_abs",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xe1, "f32x4_neg",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xe3, "f32x4_sqrt",                      immLeb,           0, 1, v128, v128, none, none) \
+	X(0xe4, "f32x4_add",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xe5, "f32x4_sub",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xe6, "f32x4_mul",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xe7, "f32x4_div",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xe8, "f32x4_min",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xe9, "f32x4_max",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xea, "f32x4_pmin",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xeb, "f32x4_pmax",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xec, "f64x2_abs",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xed, "f64x2_neg",                       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xef, "f64x2_sqrt",                      immLeb,           0, 1, v128, v128, none, none) \
+	X(0xf0, "f64x2_add",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf1, "f64x2_sub",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf2, "f64x2_mul",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf3, "f64x2_div",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf4, "f64x2_min",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf5, "f64x2_max",                       immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf6, "f64x2_pmin",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf7, "f64x2_pmax",                      immLeb,           0, 2, v128, v128, v128, none) \
+	X(0xf8, "i32x4_trunc_sat_f32x4_s",         immLeb,           0, 1, v128, v128, none, none) \
+	X(0xf9, "i32x4_trunc_sat_f32x4_u",         immLeb,           0, 1, v128, v128, none, none) \
+	X(0xfa, "f32x4_convert_i32x4_s",           immLeb,           0, 1, v128, v128, none, none) \
+	X(0xfb, "f32x4_convert_i32x4_u",           immLeb,           0, 1, v128, v128, none, none) \
+	X(0xfc, "i32x4_trunc_sat_f64x2_s_zero",    immLeb,           0, 1, v128, v128, none, none) \
+	X(0xfd, "i32x4_trunc_sat_f64x2_u_zero",    immLeb,           0, 1, v128, v128, none, none) \
+	X(0xfe, "f64x2_convert_low_i32x4_s",       immLeb,           0, 1, v128, v128, none, none) \
+	X(0xff, "f64x2_convert_low_i32x4_u",       immLeb,           0, 1, v128, v128, none, none)
+
+#endif // OPCODELIST_H